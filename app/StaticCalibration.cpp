@@ -1,6 +1,8 @@
 //
 // Created by brucknem on 02.02.21.
 //
+#include <chrono>
+#include <future>
 #include <iostream>
 #include <random>
 #include "CMakeConfig.h"
@@ -10,6 +12,7 @@
 #include "StaticCalibration/objects/WorldObject.hpp"
 #include "StaticCalibration/objects/DataSet.hpp"
 #include "StaticCalibration/CameraPoseEstimationBase.hpp"
+#include "StaticCalibration/ThreadBudget.hpp"
 #include "StaticCalibration/utils/CommandLineParser.hpp"
 #include "StaticCalibration/utils/CSVWriter.hpp"
 
@@ -49,7 +52,6 @@ void writeToCSV(static_calibration::evaluation::CSVWriter *csvWriter, int run,
 
 /** main */
 int main(int argc, char const *argv[]) {
-    srandom(time(nullptr));
     auto parsedOptions = static_calibration::utils::parseCommandLine(argc, argv);
     auto basename = boost::filesystem::path(parsedOptions.outputDir);
 
@@ -73,6 +75,15 @@ int main(int argc, char const *argv[]) {
     } else {
         estimator = new static_calibration::calibration::CameraPoseEstimation(parsedOptions.intrinsics);
     }
+    estimator->setAnalyticJacobians(parsedOptions.analyticJacobians);
+    estimator->setParallelStarts(parsedOptions.parallelStarts);
+    estimator->setSeed(parsedOptions.seed);
+    static_calibration::calibration::ThreadBudget::getInstance().setMaxThreads(parsedOptions.maxThreads);
+    estimator->setEarlyAbortOptions(parsedOptions.earlyAbortOptions);
+    estimator->setOutlierRejectionOptions(parsedOptions.outlierRejectionOptions);
+    estimator->setCovarianceEnabled(parsedOptions.estimateCovariance);
+    estimator->setSolverProfile(parsedOptions.solverProfile);
+    estimator->setCoarseToFineStages(parsedOptions.coarseToFineStages);
 
 
 #ifdef WITH_OPENCV
@@ -99,6 +110,7 @@ int main(int argc, char const *argv[]) {
     double remainingError = 1e20;
     std::map<std::string, std::string> bestMapping = dataSet.getMapping();
     std::vector<std::map<std::string, std::string>> mappings;
+    static_calibration::calibration::WarmStart baseSolution;
 
     int epoch = 0;
     int run = -1;
@@ -111,20 +123,74 @@ int main(int argc, char const *argv[]) {
     estimator->guessRotation(initialRotation);
     estimator->setIntrinsics(initialIntrinsics);
 
+    if (parsedOptions.autotune) {
+        auto timings = estimator->benchmarkSolverProfiles(
+                static_calibration::calibration::getAutotuneCandidates(parsedOptions.solverProfile));
+        for (const auto &timing: timings) {
+            std::cout << timing.profile.toString() << ": " << timing.seconds << "s, cost " << timing.finalCost
+                      << std::endl;
+        }
+        const auto &fastest = static_calibration::calibration::selectFastestProfile(timings);
+        std::cout << "Fastest: " << fastest.profile.toString() << std::endl;
+
+        boost::filesystem::create_directories(basename);
+        static_calibration::utils::writeSolverProfile((basename / "solver.yaml").string(), fastest.profile);
+        delete estimator;
+        return 0;
+    }
+
+    if (parsedOptions.compareCoarseToFine) {
+        auto timeEstimation = [&](const std::vector<static_calibration::calibration::CoarseToFineStage> &stages) {
+            estimator->setCoarseToFineStages(stages);
+            auto start = std::chrono::steady_clock::now();
+            estimator->estimate(false);
+            std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+            std::cout << (stages.empty() ? "Single solve:   " : "Coarse-to-fine: ") << duration.count() << "s, loss "
+                      << estimator->getTotalLoss() << std::endl;
+            return std::make_pair(duration.count(), estimator->getTotalLoss());
+        };
+        auto single = timeEstimation({});
+        auto coarseToFine = timeEstimation(parsedOptions.coarseToFineStages);
+        std::cout << "Speedup: " << single.first / coarseToFine.first << ", loss difference: "
+                  << coarseToFine.second - single.second << std::endl;
+        delete estimator;
+        return 0;
+    }
+
     int it = 0;
+    std::future<void> estimation;
     while (run < maxRuns) {
 #ifdef WITH_OPENCV
-        translation = estimator->getTranslation();
-        rotation = estimator->getRotation();
-        intrinsics = estimator->getIntrinsics();
+        // The solver writes the parameters of the estimator while it is running, hence read the snapshot.
+        bool estimationFinished = estimator->isEstimationFinished();
+        auto snapshot = estimator->getSnapshot();
+        if (estimationFinished) {
+            translation = estimator->getTranslation();
+            rotation = estimator->getRotation();
+            intrinsics = estimator->getIntrinsics();
+        } else {
+            translation = snapshot.translation;
+            rotation = snapshot.rotation;
+            intrinsics = snapshot.intrinsics;
+        }
 
         finalFrame = evaluationFrame * 0.5;
         static_calibration::utils::render(finalFrame, dataSet, translation, rotation, intrinsics, trackbarShowIds,
                                           maxRenderDistance);
         evaluationError = dataSet.evaluate(translation, rotation, intrinsics);
-        static_calibration::utils::renderText(finalFrame, estimator, run, numMappings, evaluationError);
+        if (estimationFinished) {
+            static_calibration::utils::renderText(finalFrame, estimator, run, numMappings, evaluationError);
+        } else {
+            std::stringstream ss;
+            ss << "Try: " << snapshot.tries << ", Iteration: " << snapshot.iterations << std::endl;
+            ss << "Cost: " << snapshot.cost << std::endl;
+            ss << "Translation: " << static_calibration::calibration::printVectorRow(translation) << std::endl;
+            ss << "Rotation:    " << static_calibration::calibration::printVectorRow(rotation) << std::endl;
+            static_calibration::utils::renderText(finalFrame, ss, run, numMappings, evaluationError);
+        }
         cv::imshow(windowName, finalFrame);
         if ((char) cv::waitKey(1) == 'q') {
+            estimator->cancel();
             break;
         }
 
@@ -200,16 +266,20 @@ int main(int argc, char const *argv[]) {
                     remainingError = 1e20;
 
                     dataSet.setMapping(bestMapping);
+                    estimator->clearWarmStart();
                     estimator->estimate(parsedOptions.logEstimationProgress);
                     initialTranslation = translation;
                     initialRotation = rotation;
                     initialIntrinsics = intrinsics;
+                    baseSolution = estimator->getWarmStart();
 
                     std::cout << "Creating mappings. This might take some minutes." << std::endl;
                     mappings = dataSet.createAllMappings(translation, rotation, intrinsics,
                                                          parsedOptions.maxPixelDistanceForMapping,
                                                          parsedOptions.maxMatchesPerImageObject,
-                                                         parsedOptions.maxNewElementsPerMapping);
+                                                         parsedOptions.maxNewElementsPerMapping, true, true, true,
+                                                         static_calibration::calibration::deriveSeed(
+                                                                 parsedOptions.seed, epoch));
                     numMappings = mappings.size();
                     if (mappings.empty() || mappings[0].empty()) {
                         break;
@@ -220,13 +290,17 @@ int main(int argc, char const *argv[]) {
             }
 
             run++;
-            estimator->setDataSet(dataSet);
+            estimator->setMappings(dataSet.getMapping(), dataSet.getMappingExtension());
             estimator->guessTranslation(initialTranslation);
             estimator->guessRotation(initialRotation);
             estimator->setIntrinsics(initialIntrinsics);
+            if (parsedOptions.warmStart && epoch > 0) {
+                // The candidates differ from the base mapping by a few correspondences only.
+                estimator->setWarmStart(baseSolution);
+            }
 
 #ifdef WITH_OPENCV
-            estimator->estimateAsync(parsedOptions.logEstimationProgress);
+            estimation = estimator->estimateAsync(parsedOptions.logEstimationProgress);
 //            estimator->estimate(parsedOptions.logEstimationProgress);
 #else //WITH_OPENCV
             estimator->estimate(parsedOptions.logEstimationProgress);
@@ -235,6 +309,9 @@ int main(int argc, char const *argv[]) {
         ++it;
     }
 
+    if (estimation.valid()) {
+        estimation.wait();
+    }
     return EXIT_SUCCESS;
 }
 
@@ -261,7 +338,6 @@ static_calibration::evaluation::CSVWriter *initCSVWriters(const std::string &bas
                << "Loss [Lambdas]"
                << "Loss [Intrinsics]"
                << "Loss [Rotations]"
-               << "Loss [Weights]"
                << "Translation [x]"
                << "Translation [y]"
                << "Translation [z]"
@@ -276,6 +352,18 @@ static_calibration::evaluation::CSVWriter *initCSVWriters(const std::string &bas
                << "Weights [Avg]"
                << "Weights [Min]"
                << "Weights [Max]"
+               << "Covariance [Valid]"
+               << "Translation Deviation [x]"
+               << "Translation Deviation [y]"
+               << "Translation Deviation [z]"
+               << "Rotation Deviation [x]"
+               << "Rotation Deviation [y]"
+               << "Rotation Deviation [z]"
+               << "Focal Length Deviation [x]"
+               << "Focal Length Deviation [y]"
+               << "Principal Point Deviation [u]"
+               << "Principal Point Deviation [v]"
+               << "Covariance [Seconds]"
                << static_calibration::evaluation::newline
                << static_calibration::evaluation::flush;
     return csvWriter;
@@ -284,6 +372,7 @@ static_calibration::evaluation::CSVWriter *initCSVWriters(const std::string &bas
 void writeToCSV(static_calibration::evaluation::CSVWriter *csvWriter, int run,
                 static_calibration::calibration::CameraPoseEstimationBase *estimator, double evaluationError) {
     auto weights = estimator->getWeights();
+    const auto &covariance = estimator->getPoseCovariance();
 
     double min_w = 1e100;
     double max_w = -1e100;
@@ -308,12 +397,16 @@ void writeToCSV(static_calibration::evaluation::CSVWriter *csvWriter, int run,
                << estimator->getLambdasLoss()
                << estimator->getIntrinsicsLoss()
                << estimator->getRotationsLoss()
-               << estimator->getWeightsLoss()
                << estimator->getTranslation()
                << estimator->getRotation()
                << estimator->getIntrinsics()
                << sum_w / weights.size()
                << min_w
                << max_w
+               << covariance.valid
+               << covariance.getTranslationDeviation()
+               << covariance.getRotationDeviation()
+               << covariance.getIntrinsicsDeviation()
+               << covariance.seconds
                << static_calibration::evaluation::newline;
 }
\ No newline at end of file
@@ -0,0 +1,108 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#include "benchmark/benchmark.h"
+#include "ceres/ceres.h"
+
+#include "StaticCalibration/CameraPoseEstimation.hpp"
+#include "StaticCalibration/CameraPoseEstimationWithIntrinsics.hpp"
+#include "StaticCalibration/camera/RenderingPipeline.hpp"
+#include "StaticCalibration/objects/DataSet.hpp"
+#include "StaticCalibration/utils/CommandLineParser.hpp"
+
+namespace static_calibration {
+    namespace benchmarks {
+
+        /**
+         * Creates a data set of posts on both sides of a road as seen from the given camera.
+         */
+        static objects::DataSet createPostsDataSet(const double *translation, const double *rotation,
+                                                   const std::vector<double> &intrinsics, int numberOfPosts) {
+            objects::DataSet dataSet;
+            const Eigen::Vector3d axis = Eigen::Vector3d::UnitZ();
+            const double height = 1.5;
+            for (int i = 0; i < numberOfPosts; i++) {
+                const std::string id = std::to_string(i);
+                const Eigen::Vector3d origin{i % 2 == 0 ? -8. : 8., 20. + 5. * i, 0};
+                calibration::Object post(id, origin, axis, height);
+                calibration::ImageObject imageObject(id);
+                for (int j = 0; j < 5; j++) {
+                    Eigen::Vector3d point = origin + axis * (height / 5) * j;
+                    imageObject.addPixel(camera::render(translation, rotation, intrinsics.data(), point.data()));
+                }
+                dataSet.add(post, imageObject);
+            }
+            return dataSet;
+        }
+
+        /**
+         * Benchmarks a full estimation with the linear solver given by the first and the number of posts given by the
+         * second argument.
+         */
+        static void BM_CameraPoseEstimation(benchmark::State &state) {
+            double translation[3] = {0, -10, 5};
+            double rotation[3] = {85, 3, -7};
+            std::vector<double> intrinsics = camera::getBlenderCameraIntrinsics();
+
+            calibration::CameraPoseEstimation estimator(intrinsics);
+            estimator.setLinearSolverType((ceres::LinearSolverType) state.range(0));
+            estimator.setDataSet(createPostsDataSet(translation, rotation, intrinsics, (int) state.range(1)));
+            state.SetLabel(ceres::LinearSolverTypeToString((ceres::LinearSolverType) state.range(0)));
+
+            for (auto _ : state) {
+                estimator.estimate(false);
+                benchmark::DoNotOptimize(estimator.getTranslation());
+            }
+        }
+
+        BENCHMARK(BM_CameraPoseEstimation)
+                ->ArgsProduct({{ceres::SPARSE_NORMAL_CHOLESKY, ceres::DENSE_SCHUR, ceres::SPARSE_SCHUR,
+                                ceres::ITERATIVE_SCHUR},
+                               {10, 50, 200}})
+                ->Unit(benchmark::kMillisecond);
+
+        /**
+         * The shipped calibration configs, relative to the config directory in the build directory.
+         */
+        static const char *shippedConfigs[] = {"config/s40_n_near/config.yaml", "config/s40_n_far/config.yaml",
+                                               "config/s50_s_near/config.yaml", "config/s50_s_far/config.yaml"};
+
+        /**
+         * Benchmarks a full estimation with the linear solver given by the first argument on the shipped calibration
+         * config given by the second argument.<br>
+         * Uses the HD map objects, marked pixels, mapping and initial guess of the config. Run from the benchmark
+         * directory of the build directory, as the configs and the misc files are copied next to it.
+         */
+        static void BM_CameraPoseEstimationOnConfig(benchmark::State &state) {
+            const char *argv[] = {"../benchmark/Benchmarks", "-c", shippedConfigs[state.range(1)]};
+            auto options = utils::parseCommandLine(3, argv);
+            objects::DataSet dataSet(options.objectsFile, options.explicitRoadMarksFile, options.pixelsFile,
+                                     options.mappingFile);
+
+            std::unique_ptr<calibration::CameraPoseEstimationBase> estimator;
+            if (options.withIntrinsics) {
+                estimator.reset(new calibration::CameraPoseEstimationWithIntrinsics(options.intrinsics));
+            } else {
+                estimator.reset(new calibration::CameraPoseEstimation(options.intrinsics));
+            }
+            estimator->setLinearSolverType((ceres::LinearSolverType) state.range(0));
+            estimator->setDataSet(dataSet);
+            state.SetLabel(std::string(ceres::LinearSolverTypeToString((ceres::LinearSolverType) state.range(0))) +
+                           " " + options.measurementPointName + "_" + options.cameraName);
+
+            for (auto _ : state) {
+                estimator->guessTranslation(options.translation);
+                estimator->guessRotation(options.rotation);
+                estimator->estimate(false);
+                benchmark::DoNotOptimize(estimator->getTranslation());
+            }
+        }
+
+        BENCHMARK(BM_CameraPoseEstimationOnConfig)
+                ->ArgsProduct({{ceres::SPARSE_NORMAL_CHOLESKY, ceres::DENSE_SCHUR, ceres::SPARSE_SCHUR,
+                                ceres::ITERATIVE_SCHUR},
+                               {0, 1, 2, 3}})
+                ->Unit(benchmark::kMillisecond);
+    }
+}
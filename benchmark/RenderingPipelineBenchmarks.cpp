@@ -0,0 +1,169 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#include "benchmark/benchmark.h"
+#include "ceres/ceres.h"
+
+#include "StaticCalibration/camera/RenderingPipeline.hpp"
+
+namespace static_calibration {
+    namespace benchmarks {
+
+        /**
+         * The world to camera transformation that concatenates the homogeneous axis rotations and inverts the result.
+         * Kept as the baseline for the closed form transformation.
+         */
+        template<typename T>
+        Eigen::Matrix<T, 4, 1> toCameraSpaceByInverse(const T *translation, const T *rotation, const T *vector) {
+            T a = -rotation[0] * (T) (M_PI / 180);
+            T b = -rotation[1] * (T) (M_PI / 180);
+            T c = rotation[2] * (T) (M_PI / 180);
+            T zero = (T) 0;
+            T one = (T) 1;
+
+            Eigen::Matrix<T, 4, 4> zAxis, yAxis, xAxis, identityZFlipped;
+            zAxis << cos(c), -sin(c), zero, zero, sin(c), cos(c), zero, zero,
+                    zero, zero, one, zero, zero, zero, zero, one;
+            yAxis << cos(b), zero, sin(b), zero, zero, one, zero, zero,
+                    -sin(b), zero, cos(b), zero, zero, zero, zero, one;
+            xAxis << one, zero, zero, zero, zero, cos(a), -sin(a), zero,
+                    zero, sin(a), cos(a), zero, zero, zero, zero, one;
+            identityZFlipped << one, zero, zero, zero, zero, one, zero, zero,
+                    zero, zero, -one, zero, zero, zero, zero, one;
+
+            Eigen::Matrix<T, 4, 4> rotationMatrix = identityZFlipped * zAxis * yAxis * xAxis;
+            return rotationMatrix.inverse() * Eigen::Matrix<T, 4, 1>(
+                    vector[0] - translation[0],
+                    vector[1] - translation[1],
+                    vector[2] - translation[2],
+                    one);
+        }
+
+        /**
+         * Camera parameters and a world position converted to T.
+         */
+        template<typename T>
+        struct RenderingParameters {
+            T translation[3] = {(T) 0, (T) -10, (T) 5};
+            T rotation[3] = {(T) 85, (T) 3, (T) -7};
+            T vector[3] = {(T) 4, (T) 20, (T) 5};
+
+            /**
+             * @constructor Seeds the derivative parts of the Jets so that they are not optimized away.
+             */
+            RenderingParameters() {
+                seed(translation, 0);
+                seed(rotation, 3);
+            }
+
+        private:
+            static void seed(double *, int) {}
+
+            template<int N>
+            static void seed(ceres::Jet<double, N> *values, int offset) {
+                for (int i = 0; i < 3 && offset + i < N; i++) {
+                    values[i].v[offset + i] = 1;
+                }
+            }
+        };
+
+        template<typename T>
+        static void BM_ToCameraSpaceByInverse(benchmark::State &state) {
+            RenderingParameters<T> parameters;
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(toCameraSpaceByInverse(parameters.translation, parameters.rotation,
+                                                                parameters.vector));
+            }
+        }
+
+        template<typename T>
+        static void BM_ToCameraSpace(benchmark::State &state) {
+            RenderingParameters<T> parameters;
+            for (auto _ : state) {
+                benchmark::DoNotOptimize(static_calibration::camera::toCameraSpace(
+                        parameters.translation, parameters.rotation, parameters.vector));
+            }
+        }
+
+        /**
+         * Creates a grid of points in front of the camera comparable to the objects of a HD map.
+         */
+        Eigen::Matrix<double, Eigen::Dynamic, 3> createPoints(int numberOfPoints) {
+            Eigen::Matrix<double, Eigen::Dynamic, 3> points(numberOfPoints, 3);
+            for (int i = 0; i < numberOfPoints; i++) {
+                points.row(i) << (i % 200) - 100., (i / 200) * 2., (i % 7) - 3.;
+            }
+            return points;
+        }
+
+        static void BM_RenderPointByPoint(benchmark::State &state) {
+            RenderingParameters<double> parameters;
+            std::vector<double> intrinsics = static_calibration::camera::getBlenderCameraIntrinsics();
+            auto points = createPoints(state.range(0));
+            std::vector<Eigen::Vector2d> pixels(points.rows());
+            std::vector<bool> visible(points.rows());
+
+            for (auto _ : state) {
+                for (int i = 0; i < points.rows(); i++) {
+                    Eigen::Vector3d point = points.row(i).transpose();
+                    bool flipped;
+                    pixels[i] = static_calibration::camera::render(parameters.translation, parameters.rotation,
+                                                                   intrinsics.data(), point.data(), flipped);
+                    visible[i] = !flipped;
+                }
+                benchmark::DoNotOptimize(pixels.data());
+            }
+            state.SetItemsProcessed(state.iterations() * points.rows());
+        }
+
+        static void BM_ProjectPoints(benchmark::State &state) {
+            RenderingParameters<double> parameters;
+            std::vector<double> intrinsics = static_calibration::camera::getBlenderCameraIntrinsics();
+            auto points = createPoints(state.range(0));
+            int numberOfPoints = (int) points.rows();
+            Eigen::ArrayXd u(numberOfPoints), v(numberOfPoints), depth(numberOfPoints);
+            Eigen::Array<bool, Eigen::Dynamic, 1> visible(numberOfPoints);
+
+            for (auto _ : state) {
+                static_calibration::camera::projectPoints(parameters.translation, parameters.rotation,
+                                                          intrinsics.data(), points.col(0).data(),
+                                                          points.col(1).data(), points.col(2).data(), numberOfPoints,
+                                                          u.data(), v.data(), depth.data(), visible.data());
+                benchmark::DoNotOptimize(u.data());
+            }
+            state.SetItemsProcessed(state.iterations() * numberOfPoints);
+        }
+
+        static void BM_ProjectPointsSinglePrecision(benchmark::State &state) {
+            RenderingParameters<double> parameters;
+            std::vector<double> intrinsics = static_calibration::camera::getBlenderCameraIntrinsics();
+            static_calibration::camera::LocalPoints points(createPoints(state.range(0)));
+            Eigen::Vector3f translation = (Eigen::Map<const Eigen::Vector3d>(parameters.translation) -
+                                           points.origin).cast<float>();
+            int numberOfPoints = points.size();
+            Eigen::ArrayXf u(numberOfPoints), v(numberOfPoints), depth(numberOfPoints);
+            Eigen::Array<bool, Eigen::Dynamic, 1> visible(numberOfPoints);
+
+            for (auto _ : state) {
+                static_calibration::camera::projectPoints(translation.data(), parameters.rotation,
+                                                          intrinsics.data(), points.x.data(), points.y.data(),
+                                                          points.z.data(), numberOfPoints,
+                                                          u.data(), v.data(), depth.data(), visible.data());
+                benchmark::DoNotOptimize(u.data());
+            }
+            state.SetItemsProcessed(state.iterations() * numberOfPoints);
+        }
+
+        BENCHMARK(BM_RenderPointByPoint)->Arg(60000)->Unit(benchmark::kMicrosecond);
+        BENCHMARK(BM_ProjectPoints)->Arg(60000)->Unit(benchmark::kMicrosecond);
+        BENCHMARK(BM_ProjectPointsSinglePrecision)->Arg(60000)->Unit(benchmark::kMicrosecond);
+
+        BENCHMARK_TEMPLATE(BM_ToCameraSpaceByInverse, double);
+        BENCHMARK_TEMPLATE(BM_ToCameraSpace, double);
+        BENCHMARK_TEMPLATE(BM_ToCameraSpaceByInverse, ceres::Jet<double, 8>);
+        BENCHMARK_TEMPLATE(BM_ToCameraSpace, ceres::Jet<double, 8>);
+        BENCHMARK_TEMPLATE(BM_ToCameraSpaceByInverse, ceres::Jet<double, 12>);
+        BENCHMARK_TEMPLATE(BM_ToCameraSpace, ceres::Jet<double, 12>);
+    }
+}
@@ -0,0 +1,73 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#include "benchmark/benchmark.h"
+#include "ceres/ceres.h"
+
+#include "StaticCalibration/camera/RenderingPipeline.hpp"
+#include "StaticCalibration/residuals/CorrespondenceResidual.hpp"
+#include "StaticCalibration/residuals/CorrespondenceWithIntrinsicsResidual.hpp"
+
+namespace static_calibration {
+    namespace benchmarks {
+
+        /**
+         * The parameters of the correspondence residuals.
+         */
+        struct CorrespondenceParameters {
+            std::vector<double> intrinsics = static_calibration::camera::getBlenderCameraIntrinsics();
+            double translation[3] = {0, -10, 5};
+            double rotation[3] = {85, 3, -7};
+            Eigen::Matrix<double, 6, 1> pose = static_calibration::camera::getPose(translation, rotation);
+            double lambda = 2;
+
+            static_calibration::calibration::ParametricPoint point{
+                    {1000, 700}, {4, 20, 5}, {0, 0, 1}, lambda, 0, 5
+            };
+        };
+
+        /**
+         * Evaluates the residual and all jacobians of the given cost function.
+         */
+        static void evaluate(benchmark::State &state, ceres::CostFunction *costFunction,
+                             const std::vector<const double *> &parameters) {
+            int numResiduals = costFunction->num_residuals();
+            std::vector<double> residuals(numResiduals);
+            std::vector<std::vector<double>> jacobianStorage;
+            for (int blockSize: costFunction->parameter_block_sizes()) {
+                jacobianStorage.emplace_back(numResiduals * blockSize);
+            }
+            std::vector<double *> jacobians;
+            for (auto &jacobian: jacobianStorage) {
+                jacobians.emplace_back(jacobian.data());
+            }
+
+            for (auto _ : state) {
+                costFunction->Evaluate(parameters.data(), residuals.data(), jacobians.data());
+                benchmark::DoNotOptimize(residuals.data());
+                benchmark::DoNotOptimize(jacobians.data());
+            }
+            delete costFunction;
+        }
+
+        static void BM_CorrespondenceResidual(benchmark::State &state) {
+            CorrespondenceParameters p;
+            evaluate(state, static_calibration::calibration::residuals::CorrespondenceResidual::create(
+                    p.point.getExpectedPixel(), p.point, p.intrinsics), {
+                             p.pose.data(), &p.lambda
+                     });
+        }
+
+        static void BM_CorrespondenceWithIntrinsicsResidual(benchmark::State &state) {
+            CorrespondenceParameters p;
+            evaluate(state, static_calibration::calibration::residuals::CorrespondenceWithIntrinsicsResidual::create(
+                    p.point.getExpectedPixel(), p.point), {
+                             p.intrinsics.data(), p.pose.data(), &p.lambda
+                     });
+        }
+
+        BENCHMARK(BM_CorrespondenceResidual);
+        BENCHMARK(BM_CorrespondenceWithIntrinsicsResidual);
+    }
+}
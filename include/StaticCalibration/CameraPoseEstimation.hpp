@@ -12,8 +12,15 @@ namespace static_calibration {
         class CameraPoseEstimation : public CameraPoseEstimationBase {
         protected:
             ceres::ResidualBlockId
-            addCorrespondenceResidualBlock(ceres::Problem &problem, const ParametricPoint &point,
-                                           ceres::LossFunction *lossFunction) override;
+            addCorrespondenceResidualBlock(ceres::Problem &problem, const std::vector<ParametricPoint> &points,
+                                           const double *weights, ceres::LossFunction *lossFunction) override;
+
+            std::unique_ptr<CameraPoseEstimationBase> clone(const objects::DataSet &dataSet) const override;
+
+            /**
+             * @constructor Copies the given estimator, but estimates on the given dataset.
+             */
+            CameraPoseEstimation(const CameraPoseEstimation &other, const objects::DataSet &dataSet);
 
         public:
             explicit CameraPoseEstimation(const std::vector<double> &intrinsics);
@@ -5,6 +5,12 @@
 #ifndef CAMERASTABILIZATION_CAMERAPOSEESTIMATIONBASE_HPP
 #define CAMERASTABILIZATION_CAMERAPOSEESTIMATIONBASE_HPP
 
+#include <atomic>
+#include <cstdint>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <random>
 #include <utility>
 #include <vector>
 #include <iostream>
@@ -20,6 +26,9 @@
 #include "residuals/CorrespondenceResidual.hpp"
 #include "residuals/DistanceFromIntervalResidual.hpp"
 #include "residuals/DistanceResidual.hpp"
+#include "residuals/PoseTransformCache.hpp"
+#include "EarlyAbortCallback.hpp"
+#include "SolverProfile.hpp"
 #include "objects/WorldObject.hpp"
 
 namespace static_calibration {
@@ -38,12 +47,289 @@ namespace static_calibration {
         /**
          * Generates a random number for the initial guesses within the given interval.
          *
+         * @param randomEngine The random number generator of the job that draws the number.
          * @param lower The lower bound of the interval.
          * @param upper The upper bound of the interval.
          *
          * @return A random number in the interval
          */
-        static double generateRandomNumber(double lower, double upper, int precision = 3);
+        double generateRandomNumber(std::mt19937_64 &randomEngine, double lower, double upper, int precision = 3);
+
+        /**
+         * Derives the seed of a job from a master seed.<br>
+         * Every job draws its own reproducible sequence, independent of the thread it runs on and of the other jobs.
+         *
+         * @param masterSeed The seed of the whole calibration.
+         * @param jobIndex The index of the job, e.g. of the try or of the batch job.
+         *
+         * @return The seed of the job.
+         */
+        std::uint64_t deriveSeed(std::uint64_t masterSeed, std::uint64_t jobIndex);
+
+        /**
+         * A consistent copy of the parameters and the progress of a running estimation.
+         */
+        struct EstimationSnapshot {
+            /**
+             * The [x, y, z] translation of the camera in world space.
+             */
+            Eigen::Vector3d translation = Eigen::Vector3d::Zero();
+
+            /**
+             * The [x, y, z] euler angle rotation of the camera.
+             */
+            Eigen::Vector3d rotation = Eigen::Vector3d::Zero();
+
+            /**
+             * The [f_x, ratio, c_x, c_y, skew] intrinsics of the pinhole camera model.
+             */
+            std::vector<double> intrinsics;
+
+            /**
+             * The number of started tries.
+             */
+            int tries = 0;
+
+            /**
+             * The number of parallel tries stopped during a solve, as a try with a lower index found a valid solution.
+             */
+            int stoppedTries = 0;
+
+            /**
+             * The last finished solver iteration of the reporting try.
+             */
+            int iterations = 0;
+
+            /**
+             * The cost of the reporting try after its last finished solver iteration.
+             */
+            double cost = 0;
+        };
+
+        /**
+         * The solution of an estimation that the first try of a following estimation starts from.
+         */
+        struct WarmStart {
+            /**
+             * The camera [tx, ty, tz, ax, ay, az] pose in world space.
+             */
+            Eigen::Matrix<double, 6, 1> pose = Eigen::Matrix<double, 6, 1>::Zero();
+
+            /**
+             * The intrinsics of the pinhole camera model.
+             */
+            std::vector<double> intrinsics;
+
+            /**
+             * The lambdas of the parametric points per [world object id, image object id] mapping entry.
+             */
+            std::map<std::pair<std::string, std::string>, std::vector<double>> lambdas;
+        };
+
+        /**
+         * A coarse stage of a coarse-to-fine estimation that runs on a subsampled copy of the dataset.
+         */
+        struct CoarseToFineStage {
+            /**
+             * Only every rowStride-th row of the center lines of the image objects becomes a correspondence.
+             */
+            int rowStride = 1;
+
+            /**
+             * The maximal number of correspondences per mapping entry, 0 for no limit.
+             */
+            int maxPointsPerEntry = 0;
+        };
+
+        /**
+         * The covariance of the camera parameters at the solution of an estimation, assuming unit pixel noise.<br>
+         * The lambdas of the points are marginalized out.
+         */
+        struct PoseCovariance {
+            /**
+             * Flag if the covariance could be calculated, i.e. the camera parameters are observable.
+             */
+            bool valid = false;
+
+            /**
+             * The covariance of the [tx, ty, tz, ax, ay, az] pose with the angle axis rotation in radians.
+             */
+            Eigen::Matrix<double, 6, 6> pose = Eigen::Matrix<double, 6, 6>::Zero();
+
+            /**
+             * The covariance of the [fx, fy, cx, cy] intrinsics, zero if the intrinsics are not optimized.
+             */
+            Eigen::Matrix4d intrinsics = Eigen::Matrix4d::Zero();
+
+            /**
+             * The wall time of the calculation in seconds.
+             */
+            double seconds = 0;
+
+            /**
+             * @get The standard deviation of the [x, y, z] translation.
+             */
+            Eigen::Vector3d getTranslationDeviation() const;
+
+            /**
+             * @get The standard deviation of the angle axis rotation about the [x, y, z] axes in degrees.
+             */
+            Eigen::Vector3d getRotationDeviation() const;
+
+            /**
+             * @get The standard deviation of the [fx, fy, cx, cy] intrinsics.
+             */
+            std::vector<double> getIntrinsicsDeviation() const;
+        };
+
+        /**
+         * A job of a batch estimation, i.e. a mapping of the data set and the initial guess to estimate from.
+         */
+        struct BatchJob {
+            /**
+             * The base mapping of the data set.
+             */
+            std::map<std::string, std::string> mapping;
+
+            /**
+             * The mapping extension on top of the base mapping.
+             */
+            std::map<std::string, std::string> mappingExtension;
+
+            /**
+             * The initial [x, y, z] translation guess.
+             */
+            Eigen::Vector3d translation = Eigen::Vector3d::Zero();
+
+            /**
+             * The initial [x, y, z] euler angle rotation guess.
+             */
+            Eigen::Vector3d rotation = Eigen::Vector3d::Zero();
+
+            /**
+             * The initial intrinsics, empty to start from the intrinsics of the estimator.
+             */
+            std::vector<double> intrinsics;
+
+            /**
+             * The solution the first try starts from, nullptr to start from the initial guess.
+             */
+            std::shared_ptr<const WarmStart> warmStart;
+        };
+
+        /**
+         * The result of a job of a batch estimation.
+         */
+        struct BatchResult {
+            /**
+             * The estimated [x, y, z] translation.
+             */
+            Eigen::Vector3d translation = Eigen::Vector3d::Zero();
+
+            /**
+             * The estimated [x, y, z] euler angle rotation.
+             */
+            Eigen::Vector3d rotation = Eigen::Vector3d::Zero();
+
+            /**
+             * The estimated intrinsics.
+             */
+            std::vector<double> intrinsics;
+
+            /**
+             * Flag if a valid solution was found.
+             */
+            bool validSolution = false;
+
+            /**
+             * The covariance of the camera parameters at the solution.
+             */
+            PoseCovariance covariance;
+
+            /**
+             * The losses of the solution.
+             */
+            double totalLoss = 0, correspondencesLoss = 0, explicitRoadMarksLoss = 0, lambdasLoss = 0,
+                    intrinsicsLoss = 0, rotationsLoss = 0;
+
+            /**
+             * The summed pixel distance of the merged mapping at the solution, see DataSet::evaluate.
+             */
+            double evaluationError = 0;
+
+            /**
+             * The wall time of the estimation in seconds.
+             */
+            double seconds = 0;
+        };
+
+        /**
+         * The rules of the outlier rejection that runs after the first solve of a try.<br>
+         * Correspondences whose pixel error exceeds thresholdScale times the median pixel error are dropped or
+         * down-weighted, then the problem is re-solved from the current state until the set of outliers is stable.
+         */
+        struct OutlierRejectionOptions {
+            /**
+             * The maximal number of re-solves, 0 to disable the outlier rejection.
+             */
+            int maxRounds = 5;
+
+            /**
+             * The outlier threshold as a multiple of the median pixel error.
+             */
+            double thresholdScale = 3;
+
+            /**
+             * The minimal outlier threshold in pixels, so that a nearly perfect fit keeps all correspondences.
+             */
+            double minThreshold = 2;
+
+            /**
+             * The maximal fraction of the correspondences that are rejected.
+             */
+            double maxOutlierRatio = 0.3;
+
+            /**
+             * Flag if the outliers are down-weighted by threshold / error, i.e. iteratively reweighted, instead of
+             * dropped.
+             */
+            bool reweight = false;
+        };
+
+        /**
+         * The costs and residuals of the residual blocks of a problem, ordered by the groups of residual blocks.
+         */
+        struct ResidualEvaluation {
+            /**
+             * The ids of the evaluated residual blocks, valid as long as the evaluated problem exists.
+             */
+            std::vector<ceres::ResidualBlockId> blockIds;
+
+            /**
+             * The cost of every residual block including its loss function.
+             */
+            std::vector<double> blockCosts;
+
+            /**
+             * The offset of the residuals of every residual block, followed by the total number of residuals.
+             */
+            std::vector<int> residualOffsets{0};
+
+            /**
+             * The residuals of all residual blocks.
+             */
+            std::vector<double> residuals;
+
+            /**
+             * Removes all evaluated residual blocks.
+             */
+            void clear();
+
+            /**
+             * @get The number of evaluated residual blocks.
+             */
+            int size() const;
+        };
 
         /**
          * Estimates the camera pose from some known correspondences between the world and image.
@@ -63,11 +349,6 @@ namespace static_calibration {
              */
             std::vector<ceres::ResidualBlockId> explicitRoadMarkResiduals;
 
-            /**
-             * The ids of the weight residual blocks.
-             */
-            std::vector<ceres::ResidualBlockId> weightResiduals;
-
             /**
              * The ids of the lambda residual blocks.
              */
@@ -78,6 +359,32 @@ namespace static_calibration {
              */
             std::vector<ceres::ResidualBlockId> rotationResiduals;
 
+            /**
+             * The residual blocks and the weights of the points that share one correspondence residual block.
+             */
+            struct ResidualBlockGroup {
+                /**
+                 * The contiguous weights of the points.
+                 */
+                double *weights = nullptr;
+
+                /**
+                 * The ids of the correspondence and lambda residual blocks of the points.
+                 */
+                ceres::ResidualBlockId correspondence = nullptr, lambda = nullptr;
+            };
+
+            /**
+             * The residual block groups in the problem by the first lambda of their points.
+             */
+            std::map<const double *, ResidualBlockGroup> residualBlockGroups;
+
+            /**
+             * The loss function shared by all lambda residual blocks.<br>
+             * Rescaled in place between the solves instead of rebuilding the residual blocks.
+             */
+            std::unique_ptr<ceres::LossFunctionWrapper> lambdaLossFunction;
+
             /**
              * The final optimization summary.
              */
@@ -98,6 +405,11 @@ namespace static_calibration {
              */
             static_calibration::objects::DataSet dataSet;
 
+            /**
+             * The solution the first try of an estimation starts from, nullptr for random starts only.
+             */
+            std::shared_ptr<const WarmStart> warmStart;
+
             /**
              * Flag if an initial guess for the rotation was set.
              */
@@ -109,14 +421,15 @@ namespace static_calibration {
             bool hasTranslationGuess = false;
 
             /**
-             * Flag if the optimization is finished, i.e. ceres is finished minimizing.
+             * Flag if the optimization is finished, i.e. ceres is finished minimizing.<br>
+             * Set as the very last access of an estimation to the estimator.
              */
-            bool optimizationFinished = true;
+            std::atomic<bool> optimizationFinished{true};
 
             /**
-             * An additional scaling factor for the weight residuals.
+             * Flag if the running estimation should stop as soon as possible.
              */
-            double weightResidualScalingFactor = std::numeric_limits<double>::max();
+            std::atomic<bool> cancelRequested{false};
 
             /**
              * An additional scaling factor for the lambda residuals.
@@ -145,6 +458,165 @@ namespace static_calibration {
              */
             int maxTriesUntilAbort = 50;
 
+            /**
+             * The number of tries that run at once on independent copies of the estimator.
+             */
+            int numParallelStarts = 1;
+
+            /**
+             * The master seed of the random initial guesses, the generator is seeded per try by deriveSeed.
+             */
+            std::uint64_t seed = 0;
+
+            /**
+             * The random number generator of the current try.
+             */
+            std::mt19937_64 randomEngine;
+
+            /**
+             * The settings of the ceres solver.
+             */
+            SolverProfile solverProfile;
+
+            /**
+             * The elimination order of the lambdas used by the Schur complement based solvers.<br>
+             * The lambdas are eliminated first, then the camera parameters.
+             */
+            std::shared_ptr<ceres::ParameterBlockOrdering> linearSolverOrdering;
+
+            /**
+             * The rules that stop hopeless or stalled solves of the first solve of a try early.
+             */
+            EarlyAbortOptions earlyAbortOptions;
+
+            /**
+             * The coarse stages that run before the estimation on the full dataset, from coarse to fine.<br>
+             * Every stage starts from the solution of the previous stage, the full estimation from the last one.
+             */
+            std::vector<CoarseToFineStage> coarseToFineStages;
+
+            /**
+             * The rules of the outlier rejection that runs after the first solve of a try.
+             */
+            OutlierRejectionOptions outlierRejectionOptions;
+
+            /**
+             * Flag if the covariance of the camera parameters is calculated after every successful try.
+             */
+            bool covarianceEnabled = true;
+
+            /**
+             * The covariance of the camera parameters at the solution of the last estimation.
+             */
+            PoseCovariance poseCovariance;
+
+            /**
+             * The best cost reached so far by the first solves of the tries of the current estimation.<br>
+             * Updated after every iteration. A parallel try starts from the best cost of the earlier rounds, which is
+             * updated after every round.
+             */
+            std::atomic<double> bestCost{std::numeric_limits<double>::infinity()};
+
+            /**
+             * Flag if the current solve refines an accepted solution, which is never aborted early.
+             */
+            bool refining = false;
+
+            /**
+             * Flag if the last solve was aborted early as hopeless.
+             */
+            bool abortedEarly = false;
+
+            /**
+             * Publishes the progress of every solver iteration and aborts the solve on cancellation.
+             */
+            class ProgressCallback : public ceres::IterationCallback {
+            private:
+                /**
+                 * The estimator that runs the solve.
+                 */
+                CameraPoseEstimationBase &estimator;
+
+            public:
+                /**
+                 * @constructor
+                 */
+                explicit ProgressCallback(CameraPoseEstimationBase &estimator);
+
+                ceres::CallbackReturnType operator()(const ceres::IterationSummary &summary) override;
+            };
+
+            /**
+             * The callback of the solves of this estimator.
+             */
+            ProgressCallback progressCallback;
+
+            /**
+             * The estimator that started this estimator as parallel try, coarse stage or batch worker, nullptr if
+             * none.<br>
+             * Forwards its cancellation.
+             */
+            const CameraPoseEstimationBase *parent = nullptr;
+
+            /**
+             * The estimator that receives the progress of this estimator as parallel try or coarse stage, nullptr if
+             * none.<br>
+             * Batch workers keep their progress, as the jobs never touch the state of the estimator.
+             */
+            CameraPoseEstimationBase *progressReceiver = nullptr;
+
+            /**
+             * The lowest index of the parallel tries of an estimation that found a valid solution, shared by the
+             * parallel tries. nullptr if this is no parallel try.
+             */
+            std::atomic<int> *firstValidTry = nullptr;
+
+            /**
+             * The index of the current try.
+             */
+            int currentTry = 0;
+
+            /**
+             * @get Flag if a parallel try with a lower index found a valid solution, hence the solution of the current
+             * try is never used.
+             */
+            bool isSuperseded() const;
+
+            /**
+             * Guards the snapshot.
+             */
+            mutable std::mutex snapshotMutex;
+
+            /**
+             * The progress of the current estimation, written by the solving threads.
+             */
+            EstimationSnapshot snapshot;
+
+            /**
+             * Resets the cancellation, the finished flag and the snapshot before an estimation.
+             */
+            void startEstimation();
+
+            /**
+             * Runs the tries of the estimation and publishes the result.
+             *
+             * @param logSummary Flag to log the ceres summary output to stdout.
+             */
+            void runEstimation(bool logSummary);
+
+            /**
+             * Writes the current parameters and the given progress to the snapshot of the root estimator.
+             *
+             * @param iteration The last finished solver iteration.
+             * @param cost The cost after the iteration.
+             */
+            void publishSnapshot(int iteration, double cost);
+
+            /**
+             * @get The estimator that publishes the snapshot, i.e. the progress receiver of a parallel try or this.
+             */
+            CameraPoseEstimationBase &getRoot();
+
             /**
              * The final loss of the lambda residuals after optimization.
              */
@@ -165,15 +637,7 @@ namespace static_calibration {
              */
             double rotationsLoss = 0;
 
-            /**
-             * The final loss of the weight residuals after optimization.
-             */
-            double weightsLoss = 0;
 
-            /**
-             * The final loss of all residuals after optimization.
-             */
-            double totalLoss = 0;
 
 
             /**
@@ -195,115 +659,176 @@ namespace static_calibration {
              * Adds some additional weak constraints on the rotation that guide the optimizer towards useful solutions.
              *
              * - rx in [60, 110]
-             * - ry in [-10, 10]
+             * - ry in [-20, 20]
              */
             void addRotationConstraints(ceres::Problem &problem);
 
             /**
-             * Evaluates the problem with the given options.
-             *
-             * @param problem The ceres problem.
-             * @param evalOptions The options, i.e. a lost of residual ids to evaluate only specific residuals.
-             *
-             * @return The loss of the requested residuals.
+             * Sets the current lambda residual scaling factor on the shared loss function.
              */
-            static double evaluate(ceres::Problem &problem,
-                                   const ceres::Problem::EvaluateOptions &evalOptions = ceres::Problem::EvaluateOptions());
+            void updateLossFunctions();
 
             /**
-             * Evaluates the problem for the correspondence residuals.
-             *
-             * @param problem The ceres problem.
+             * Resets the weights of the correspondences to 1 in place.
+             */
+            void resetWeights();
+
+            /**
+             * Calculates the pixel distance between the expected pixel of the point and its projection.
              *
-             * @return The loss of the residuals.
+             * @return The pixel distance, infinity if the point is behind the camera.
              */
-            void evaluateCorrespondenceResiduals(ceres::Problem &problem);
+            double calculatePixelError(const ParametricPoint &point) const;
 
             /**
-             * Evaluates the problem for the explicit road marks residuals.
+             * Collects the weights of the given points with their current pixel errors.
              *
-             * @param problem The ceres problem.
+             * @param points The parametric points.
+             * @param groups The [begin, end) ranges of the points that share their world object and image object.
+             * @param pointErrors The list to add the [weight, pixel error] pairs to.
+             */
+            void collectPointErrors(const std::vector<ParametricPoint> &points,
+                                    const std::vector<std::pair<int, int>> &groups,
+                                    std::vector<std::pair<double *, double>> &pointErrors) const;
+
+            /**
+             * Drops or down-weights the correspondences whose pixel error exceeds the outlier threshold.
              *
-             * @return The loss of the residuals.
+             * @return true if the set of outliers changed, false if it is stable.
              */
-            void evaluateExplicitRoadMarkResiduals(ceres::Problem &problem);
+            bool updateOutlierWeights();
 
             /**
-             * Evaluates the problem for the weight residuals.
+             * Re-solves from the current state with the outliers dropped or down-weighted until the set of outliers
+             * is stable or the maximal number of rounds is reached.
              *
-             * @param problem The ceres problem.
+             * @param logSummary Flag to log the ceres summary output to stdout.
+             */
+            void rejectOutliers(bool logSummary);
+
+            /**
+             * Creates the ceres options used for optimization.
              *
-             * @return The loss of the residuals.
+             * @param logSummary Flag to log the ceres summary output to stdout.
              */
-            void evaluateWeightResiduals(ceres::Problem &problem);
+            ceres::Solver::Options setupOptions(bool logSummary);
 
             /**
-             * Evaluates the problem for the lambda residuals.
+             * Runs a single try of the estimation from a new initial guess.
              *
-             * @param problem The ceres problem.
+             * @param logSummary Flag to log the ceres summary output to stdout.
+             * @param tryIndex The index of the try within the estimation, seeds the random initial guess.
+             * @param warmStarted Flag if the try starts from the warm start instead of the initial guess.
              *
-             * @return The loss of the residuals.
+             * @return true if the try found a valid solution, false else.
+             */
+            bool runTry(bool logSummary, int tryIndex, bool warmStarted = false);
+
+            /**
+             * Sets the pose and intrinsics of the warm start.<br>
+             * The lambdas of the mapping entries of the warm start are taken over, all other lambdas are initialized
+             * to the point on their world object that is closest to the viewing ray of their pixel.
              */
-            void evaluateLambdaResiduals(ceres::Problem &problem);
+            void applyWarmStart();
 
             /**
-             * Evaluates the problem for the rotation residuals.
+             * Calculates the lambda of the point on the world object of the given point that is closest to the viewing
+             * ray of its expected pixel from the current pose.
              *
-             * @param problem The ceres problem.
+             * @return The lambda clamped to the valid interval of the point.
+             */
+            double calculateClosestLambda(const ParametricPoint &point) const;
+
+            /**
+             * Runs the tries of the estimation on numParallelStarts copies of the estimator at once.<br>
+             * The tries run in rounds of numParallelStarts consecutive indices. The valid try with the lowest index
+             * wins, hence a valid solution stops the running tries with a higher index and no further round starts.
+             * The running tries with a lower index finish, as they may still win. The estimation is therefore
+             * reproducible for a fixed seed.
              *
-             * @return The loss of the residuals.
+             * @return true if a valid solution was found, false else.
              */
-            void evaluateRotationResiduals(ceres::Problem &problem);
+            bool estimateParallel();
 
             /**
-             * Evaluates the problem for all residuals.
+             * Runs the coarse stages of the estimation on subsampled copies of the dataset.
              *
-             * @param problem The ceres problem.
+             * @return The solution of the last finished stage, or the current warm start if no stage finished.
+             */
+            std::shared_ptr<const WarmStart> estimateCoarseStages();
+
+            /**
+             * Calculates the covariance of the camera parameters at the current solution of the problem.<br>
+             * Every residual block depends on the camera parameters and at most one other parameter block, e.g. the
+             * lambdas of a correspondence residual block. The normal equations of these blocks are small and
+             * independent, hence they are eliminated per block by the Schur complement, leaving a system of the size
+             * of the camera parameters that is inverted.
+             */
+            void calculateCovariance();
+
+            /**
+             * Takes over the parameters and losses of the solution of the given estimator.
              *
-             * @return The loss of the residuals.
+             * @param other An estimator of the same dataset.
              */
-            void evaluateAllResiduals(ceres::Problem &problem);
+            void adoptSolution(const CameraPoseEstimationBase &other);
 
             /**
-             * Creates the ceres options used for optimization.
+             * Estimates a job of a batch estimation on the data set of the estimator.
              *
-             * @param logSummary Flag to log the ceres summary output to stdout.
+             * @param job The job to estimate.
+             * @param defaultIntrinsics The initial intrinsics if the job has none.
+             *
+             * @return The result of the job.
              */
-            static ceres::Solver::Options setupOptions(bool logSummary);
+            BatchResult estimateJob(const BatchJob &job, const std::vector<double> &defaultIntrinsics);
 
             /**
-             * Adds a correspondence residual block based on the given point to the problem.
+             * Adds the correspondence and lambda residual blocks of the given parametric points to the problem.
+             * <br>
+             * The points of a group share one residual block of each kind. Groups are split into residual blocks of at
+             * most maxPointsPerResidualBlock points.
              *
              * @param problem The ceres problem
-             * @param point The point used in the residual block.
-             *
-             * @return The residual block id.
+             * @param points The parametric points.
+             * @param groups The [begin, end) ranges of the points that share their world object and image object.
+             * @param correspondenceResidualIds The list to add the correspondence residual block ids to.
+             * @param huberLoss The parameter of the huber loss applied to every single correspondence.
              */
-            virtual ceres::ResidualBlockId
-            addCorrespondenceResidualBlock(ceres::Problem &problem, const ParametricPoint &point,
-                                           ceres::LossFunction *lossFunction);
+            void addResidualBlocks(ceres::Problem &problem, const std::vector<ParametricPoint> &points,
+                                   const std::vector<std::pair<int, int>> &groups,
+                                   std::vector<ceres::ResidualBlockId> &correspondenceResidualIds, double huberLoss);
 
             /**
-             * Adds a lambda residual block based on the given point to the problem.
+             * Removes the residual blocks, lambdas and weights of the residual block group with the given first lambda
+             * from the problem.
+             */
+            void removeResidualBlockGroup(const double *lambda);
+
+            /**
+             * Adds a correspondence residual block based on the given points to the problem.
              *
              * @param problem The ceres problem
-             * @param point The point used in the residual block.
-             * @param lambdaMin The height of the world object.
+             * @param points The points used in the residual block. Their lambdas are stored contiguously.
+             * @param weights The contiguous fixed weights of the points, read at every evaluation.
+             * @param lossFunction The loss function applied to every single point.
              *
              * @return The residual block id.
              */
-            ceres::ResidualBlockId
-            addLambdaResidualBlock(ceres::Problem &problem, const ParametricPoint &point) const;
+            virtual ceres::ResidualBlockId
+            addCorrespondenceResidualBlock(ceres::Problem &problem, const std::vector<ParametricPoint> &points,
+                                           const double *weights, ceres::LossFunction *lossFunction);
 
             /**
-             * Adds a lambda residual block based on the given point to the problem.
+             * Adds a lambda residual block based on the given points to the problem.
              *
              * @param problem The ceres problem
-             * @param weight The weight to constrain.
+             * @param points The points used in the residual block. Their lambdas are stored contiguously.
              *
              * @return The residual block id.
              */
-            ceres::ResidualBlockId addWeightResidualBlock(ceres::Problem &problem, double *weight) const;
+            ceres::ResidualBlockId
+            addLambdaResidualBlock(ceres::Problem &problem, const std::vector<ParametricPoint> &points) const;
 
         protected:
 
@@ -312,45 +837,103 @@ namespace static_calibration {
              */
             double intrinsicsLoss = 0;
 
+            /**
+             * The final loss of all residuals after optimization.
+             */
+            double totalLoss = 0;
+
+
+            /**
+             * The costs and residuals of the residual blocks after the last solve.
+             */
+            ResidualEvaluation residualEvaluation;
 
             /**
-             * Evaluates the problem for the residuals of the requested residual blocks.
+             * Evaluates the residual blocks of one group and appends their costs and residuals to the residual
+             * evaluation.
              *
              * @param problem The ceres problem.
-             * @param blockIds The list of residual block ids to evaluate.
+             * @param blockIds The list of residual block ids of the group.
              *
-             * @return The loss of the requested residuals.
+             * @return The loss of the group.
              */
-            static double evaluate(ceres::Problem &problem, const std::vector<ceres::ResidualBlockId> &blockIds);
+            double evaluateGroup(const ceres::Problem &problem, const std::vector<ceres::ResidualBlockId> &blockIds);
 
             /**
-             * Solves the ceres problem, i.e. runs the optimization and evaluates the remaining losses.
+             * Evaluates all residual blocks in a single pass and sets the losses of the groups and the total loss.
+             *
+             * @param problem The ceres problem.
+             */
+            virtual void evaluateResiduals(const ceres::Problem &problem);
+
+            /**
+             * Solves the ceres problem, i.e. runs the optimization and evaluates the remaining losses.<br>
+             * The problem is created on the first solve and reused by all following solves.
              *
              * @param logSummary Flag to log the ceres summary output to stdout.
              */
-            virtual ceres::Problem solveProblem(bool logSummary);
+            virtual void solveProblem(bool logSummary);
 
-            virtual /**
-                 * Creates the ceres problem from the list of known world objects.
-                 */
-            ceres::Problem createProblem();
+            /**
+             * Creates the ceres problem from the list of known world objects.<br>
+             * The residual blocks reference the parameters in place, hence the problem stays valid as long as the
+             * dataset, the intrinsics and the residual options do not change.
+             */
+            virtual void createProblem();
 
             /**
-                 * The current camera [x, y, z] translation in world space used for optimization.
-                 */
-            Eigen::Vector3d translation;
+             * Discards the ceres problem so that it is recreated on the next solve.
+             */
+            void resetProblem();
+
             /**
-                 * The current camera [x, y, z] euler angle rotation around the world space axis.
-                 */
-            Eigen::Vector3d rotation;
+             * Copies the given values over the intrinsics without reallocating them, as the problem references the
+             * intrinsics in place.
+             */
+            void copyIntrinsicsInPlace(const std::vector<double> &values);
 
             /**
-             * The weights of the correspondence residual blocks.
+             * The current camera [tx, ty, tz, ax, ay, az] pose in world space used for optimization.<br>
+             * The rotation is stored in angle axis representation so that the pose is a single parameter block.
              */
-            std::vector<double *> weights;
+            Eigen::Matrix<double, 6, 1> pose;
 
             /**
-             * The current [f_x, ratio, c_x, c_y, skew] intrinsics values of the pinhole camera model.
+             * The camera transform of the current pose, calculated once per solver iteration.
+             */
+            residuals::PoseTransformCache poseTransformCache;
+
+            /**
+             * The ceres problem that is reused by all solves of the current dataset.
+             */
+            std::unique_ptr<ceres::Problem> problem;
+
+            /**
+             * @set The translation part of the pose.
+             */
+            void setTranslation(const Eigen::Vector3d &translation);
+
+            /**
+             * @set The rotation part of the pose from the [x, y, z] euler angle rotation.
+             */
+            void setRotation(const Eigen::Vector3d &rotation);
+
+            /**
+             * The fixed weights of the correspondences, stored contiguously per correspondence residual block.<br>
+             * 1 for inliers, set by the outlier rejection between the solves. Referenced by the correspondence residual
+             * blocks, hence only the values may be changed.
+             */
+            std::vector<std::vector<double>> weights;
+
+            /**
+             * The maximal number of points that share one correspondence residual block.<br>
+             * Bounds the size of the dense jacobians with respect to the lambdas of a block.
+             */
+            int maxPointsPerResidualBlock = 16;
+
+            /**
+             * The current [f_x, ratio, c_x, c_y, skew] intrinsics values of the pinhole camera model.<br>
+             * The first four values are optimized as a single parameter block.
              */
             std::vector<double> intrinsics;
 
@@ -359,6 +942,13 @@ namespace static_calibration {
              */
             std::vector<double> initialIntrinsics;
 
+            /**
+             * Flag if the correspondence residuals use the hand derived jacobians instead of automatic
+             * differentiation.<br>
+             * Only the hand derived jacobians reuse the camera transform of the pose transform cache.
+             */
+            bool analyticJacobians = true;
+
             /**
              * Creates a ceres loss function based on the huber loss with additional scaling.
              *
@@ -368,6 +958,29 @@ namespace static_calibration {
              */
             static ceres::ScaledLoss *getScaledHuberLoss(double scale);
 
+            /**
+             * @constructor Copies the settings and the current parameters of the given estimator, but estimates on the
+             * given dataset.<br>
+             * The copy owns its lambdas and creates its own problem, hence it can be optimized independently.
+             */
+            CameraPoseEstimationBase(const CameraPoseEstimationBase &other, const objects::DataSet &dataSet);
+
+            /**
+             * @constructor Copies the settings, the dataset and the current parameters of the given estimator.<br>
+             * The copy owns its lambdas and creates its own problem, hence it can be optimized independently.
+             */
+            CameraPoseEstimationBase(const CameraPoseEstimationBase &other);
+
+            /**
+             * @return An independent copy of the estimator on the given dataset, e.g. for batch workers.
+             */
+            virtual std::unique_ptr<CameraPoseEstimationBase> clone(const objects::DataSet &dataSet) const;
+
+            /**
+             * @return An independent copy of the estimator, e.g. for parallel tries.
+             */
+            std::unique_ptr<CameraPoseEstimationBase> clone() const;
+
         public:
             /**
              * @constructor
@@ -385,6 +998,26 @@ namespace static_calibration {
 
             void setDataSet(const objects::DataSet &dataSet);
 
+            /**
+             * Sets the mapping extension of the dataset.<br>
+             * Only the residual blocks of the correspondences that enter or leave the mapping are added to or removed
+             * from the problem, the residual blocks and parameters of all other correspondences stay in place.
+             *
+             * @param mappingExtension The extension to the mapping from 3D world objects to 2D image objects.
+             */
+            void setMappingExtension(const std::map<std::string, std::string> &mappingExtension);
+
+            /**
+             * Sets the mapping and the mapping extension of the dataset.<br>
+             * If only the extension changed the problem is updated by setMappingExtension, otherwise it is recreated
+             * on the next solve.
+             *
+             * @param mapping The mapping from 3D world objects to 2D image objects.
+             * @param mappingExtension The extension to the mapping from 3D world objects to 2D image objects.
+             */
+            void setMappings(const std::map<std::string, std::string> &mapping,
+                             const std::map<std::string, std::string> &mappingExtension);
+
             /**
              * Estimates the camera translation and rotation based on the known correspondences between the world and
              * image.
@@ -394,11 +1027,31 @@ namespace static_calibration {
             virtual void estimate(bool logSummary);
 
             /**
-             * Async threaded wrapper for the pose estimation function.
+             * Async threaded wrapper for the pose estimation function.<br>
+             * The estimation is finished when the returned future is ready. Use getSnapshot to read the parameters
+             * while it is running.
              *
              * @param logSummary Flag to log the ceres summary output to stdout.
+             *
+             * @return The future of the estimation.
+             */
+            std::future<void> estimateAsync(bool logSummary = false);
+
+            /**
+             * Requests the running estimation to stop.<br>
+             * The running solves abort after their current iteration and no new tries are started.
+             */
+            void cancel();
+
+            /**
+             * @return true if the cancellation of the running estimation was requested, false else.
+             */
+            bool isCancelled() const;
+
+            /**
+             * @get A consistent copy of the parameters and the progress of the running or last estimation.
              */
-            std::thread estimateAsync(bool logSummary = false);
+            EstimationSnapshot getSnapshot() const;
 
             /**
              * Based on the known world positions calculates an initial guess for the camera translation and rotation.
@@ -427,12 +1080,17 @@ namespace static_calibration {
             void guessRotation(const T &rotation);
 
             /**
-             * @get
+             * @get The [tx, ty, tz, ax, ay, az] pose of the camera, i.e. the pose parameter block of the problem.
              */
-            const Eigen::Vector3d &getTranslation() const;
+            const Eigen::Matrix<double, 6, 1> &getPose() const;
 
             /**
-             * @get
+             * @get The [x, y, z] translation of the camera in world space.
+             */
+            Eigen::Vector3d getTranslation() const;
+
+            /**
+             * @get The [x, y, z] euler angle rotation of the camera converted from the optimized pose.
              */
             Eigen::Vector3d getRotation() const;
 
@@ -456,14 +1114,100 @@ namespace static_calibration {
              */
             friend std::ostream &operator<<(std::ostream &os, const CameraPoseEstimationBase *estimator);
 
+            /**
+             * @set The number of tries that run at once, 1 to run the tries one after another.
+             */
+            void setParallelStarts(int value);
+
+            /**
+             * @set The master seed of the random initial guesses.<br>
+             * Estimations with the same seed draw the same initial guesses for every try, also in parallel.
+             */
+            void setSeed(std::uint64_t value);
+
             /**
              * @set
              */
-            void setWeightPenalizeScale(double weightPenalizeScale);
+            void setOutlierRejectionOptions(const OutlierRejectionOptions &value);
+
+            /**
+             * @set Flag if the covariance of the camera parameters is calculated after every successful try.
+             */
+            void setCovarianceEnabled(bool value);
+
+            /**
+             * @set The rules that stop hopeless or stalled solves early.
+             */
+            void setEarlyAbortOptions(const EarlyAbortOptions &value);
+
+            /**
+             * @set The type of the linear solver. The Schur complement based solvers eliminate the lambdas first.
+             */
+            void setLinearSolverType(ceres::LinearSolverType value);
+
+            /**
+             * @set The coarse stages that run before the estimation on the full dataset, from coarse to fine.
+             */
+            void setCoarseToFineStages(const std::vector<CoarseToFineStage> &value);
+
+            /**
+             * @get The current solution as the warm start of a following estimation.
+             */
+            WarmStart getWarmStart() const;
+
+            /**
+             * @set The solution the first try of the following estimations starts from.<br>
+             * The following tries start from the initial guess as usual.
+             */
+            void setWarmStart(const WarmStart &value);
+
+            /**
+             * Starts all following tries from the initial guess.
+             */
+            void clearWarmStart();
 
             /**
              * @get
              */
+            const SolverProfile &getSolverProfile() const;
+
+            /**
+             * @set
+             */
+            void setSolverProfile(const SolverProfile &value);
+
+            /**
+             * Times a single solve with each of the given solver profiles.<br>
+             * All solves start from the same initial guess and are never aborted early, the current parameters and the
+             * solver profile of the estimator are restored afterwards.
+             *
+             * @param candidates The solver profiles to time.
+             * @param repetitions The number of solves per profile of which the fastest is reported.
+             *
+             * @return The timings of the profiles in the order of the candidates.
+             */
+            std::vector<SolverProfileTiming> benchmarkSolverProfiles(const std::vector<SolverProfile> &candidates,
+                                                                     int repetitions = 3);
+
+            /**
+             * Estimates the given jobs on a pool of copies of the estimator.<br>
+             * The copies keep the configuration of the estimator but never touch its state, hence the estimator can
+             * be used while the batch runs. The workers share the ThreadBudget, consecutive jobs of a worker with the
+             * same base mapping only update the residual blocks of the mapping extension.
+             *
+             * @param worldMap The data set with the world objects and image objects the mappings refer to.
+             * @param jobs The jobs to estimate.
+             * @param numWorkers The number of jobs that run at once, 0 to derive it from the ThreadBudget.
+             *
+             * @return The results in the order of the jobs.
+             */
+            std::vector<BatchResult> estimateBatch(const objects::DataSet &worldMap, const std::vector<BatchJob> &jobs,
+                                                   int numWorkers = 0) const;
+
+            /**
+             * @get The weights of the correspondences, 1 for inliers, less for down-weighted and 0 for dropped
+             * outliers.
+             */
             std::vector<double> getWeights();
 
             /**
@@ -495,12 +1239,17 @@ namespace static_calibration {
             /**
              * @get
              */
-            double getWeightsLoss() const;
+            double getTotalLoss() const;
 
             /**
-             * @get
+             * @get The costs and residuals of the residual blocks after the last solve.
              */
-            double getTotalLoss() const;
+            const ResidualEvaluation &getResidualEvaluation() const;
+
+            /**
+             * @get The covariance of the camera parameters at the solution of the last estimation.
+             */
+            const PoseCovariance &getPoseCovariance() const;
 
             std::vector<double> getLambdas();
 
@@ -511,8 +1260,23 @@ namespace static_calibration {
              */
             const std::vector<double> &getIntrinsics() const;
 
+            /**
+             * @set The initial intrinsics.<br>
+             * The problem is kept if the values are unchanged, otherwise it is recreated on the next solve.
+             */
             void setIntrinsics(const std::vector<double> &intrinsics);
 
+            /**
+             * @get The problem of the current dataset, nullptr before the first solve or after it was discarded.
+             */
+            const ceres::Problem *getProblem() const;
+
+            /**
+             * @set Flag if the correspondence residuals use the hand derived jacobians instead of automatic
+             * differentiation.
+             */
+            void setAnalyticJacobians(bool value);
+
             /**
              * @get
              */
@@ -23,13 +23,19 @@ namespace static_calibration {
 
 
             /**
-             * Evaluates the problem for the intrinsics residuals.
+             * Evaluates all residual blocks including the intrinsics residuals in a single pass.
              *
              * @param problem The ceres problem.
-             *
-             * @return The loss of the residuals.
              */
-            void evaluateIntrinsicsResiduals(ceres::Problem &problem);
+            void evaluateResiduals(const ceres::Problem &problem) override;
+
+            std::unique_ptr<CameraPoseEstimationBase> clone(const objects::DataSet &dataSet) const override;
+
+            /**
+             * @constructor Copies the given estimator, but estimates on the given dataset.
+             */
+            CameraPoseEstimationWithIntrinsics(const CameraPoseEstimationWithIntrinsics &other,
+                                               const objects::DataSet &dataSet);
 
         public:
 
@@ -40,15 +46,13 @@ namespace static_calibration {
 
             void addIntrinsicsConstraints(ceres::Problem &problem);
 
-            ceres::Problem solveProblem(bool logSummary) override;
-
             void resetParameters() override;
 
-            ceres::Problem createProblem() override;
+            void createProblem() override;
 
             ceres::ResidualBlockId
-            addCorrespondenceResidualBlock(ceres::Problem &problem, const ParametricPoint &point,
-                                           ceres::LossFunction *lossFunction) override;
+            addCorrespondenceResidualBlock(ceres::Problem &problem, const std::vector<ParametricPoint> &points,
+                                           const double *weights, ceres::LossFunction *lossFunction) override;
 
         };
     }
@@ -0,0 +1,105 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#ifndef STATICCALIBRATION_EARLYABORTCALLBACK_HPP
+#define STATICCALIBRATION_EARLYABORTCALLBACK_HPP
+
+#include <atomic>
+#include <limits>
+#include <vector>
+#include "ceres/ceres.h"
+
+namespace static_calibration {
+    namespace calibration {
+
+        /**
+         * The rules that stop a solve before it reaches the maximal number of iterations.<br>
+         * A solve whose cost is too high is aborted as hopeless, a solve whose cost stalls is terminated and kept.
+         * All rules are disabled by default.
+         */
+        struct EarlyAbortOptions {
+            /**
+             * The number of iterations after which the cost is compared to the maximal cost and the best cost.<br>
+             * From then on the rules are checked after every iteration.
+             */
+            int minIterations = 10;
+
+            /**
+             * The maximal cost after the minimal number of iterations, infinity to disable.
+             */
+            double maxCost = std::numeric_limits<double>::infinity();
+
+            /**
+             * The number of iterations over which the relative decrease of the cost is measured, 0 to disable.
+             */
+            int stallIterations = 0;
+
+            /**
+             * The minimal relative decrease of the cost over the stall iterations.
+             */
+            double minRelativeDecrease = 1e-3;
+
+            /**
+             * The maximal ratio of the cost after the minimal number of iterations to the best cost reached so far by
+             * the earlier tries and the own solve, infinity to disable.<br>
+             * Parallel tries only compare against the tries of the earlier rounds, as comparing against the running
+             * tries would make the estimation depend on the timing of the threads.
+             */
+            double maxRatioToBestCost = std::numeric_limits<double>::infinity();
+        };
+
+        /**
+         * Stops a solve as soon as one of the early abort rules applies.<br>
+         * Create one callback per solve, as it keeps the cost history of the solve.
+         */
+        class EarlyAbortCallback : public ceres::IterationCallback {
+        private:
+            /**
+             * The rules of the early abort.
+             */
+            EarlyAbortOptions options;
+
+            /**
+             * The best cost reached so far by the earlier tries and this solve.
+             */
+            std::atomic<double> &bestCost;
+
+            /**
+             * The costs of the iterations of the solve.
+             */
+            std::vector<double> costs;
+
+            /**
+             * Flag if the solve was aborted as hopeless by this callback.
+             */
+            bool aborted = false;
+
+        public:
+            /**
+             * @constructor
+             *
+             * @param options The rules of the early abort.
+             * @param bestCost The best cost reached so far by the earlier tries, updated by this solve.
+             */
+            EarlyAbortCallback(const EarlyAbortOptions &options, std::atomic<double> &bestCost);
+
+            /**
+             * @destructor
+             */
+            ~EarlyAbortCallback() override = default;
+
+            /**
+             * Publishes the cost of the iteration to the best cost and checks the early abort rules.
+             */
+            ceres::CallbackReturnType operator()(const ceres::IterationSummary &summary) override;
+
+            /**
+             * @return true if the solve was aborted as hopeless by this callback, false else.
+             */
+            bool hasAborted() const;
+        };
+    }
+}
+
+#endif //STATICCALIBRATION_EARLYABORTCALLBACK_HPP
@@ -0,0 +1,131 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#ifndef STATICCALIBRATION_SOLVERPROFILE_HPP
+#define STATICCALIBRATION_SOLVERPROFILE_HPP
+
+#include <string>
+#include <vector>
+#include "ceres/ceres.h"
+
+namespace static_calibration {
+    namespace calibration {
+
+        /**
+         * The settings of the ceres solver that are tuned per camera site.
+         */
+        struct SolverProfile {
+            /**
+             * The type of the linear solver used in the steps of the optimization.
+             */
+            ceres::LinearSolverType linearSolverType = ceres::SPARSE_NORMAL_CHOLESKY;
+
+            /**
+             * The strategy of the trust region minimizer.
+             */
+            ceres::TrustRegionStrategyType trustRegionStrategyType = ceres::LEVENBERG_MARQUARDT;
+
+            /**
+             * Flag if the minimizer may take steps that increase the cost.
+             */
+            bool useNonmonotonicSteps = false;
+
+            /**
+             * The maximal number of iterations of a solve.
+             */
+            int maxNumIterations = 400;
+
+            /**
+             * The number of threads used by a single solve, 0 to derive it from the size of the problem.<br>
+             * The threads are leased from the ThreadBudget, hence a solve may get fewer threads if the cores are busy.
+             */
+            int numThreads = 0;
+
+            /**
+             * The number of residual blocks per thread if the number of threads is derived from the problem size.<br>
+             * Small problems solve faster on few threads and leave the remaining cores to concurrent solves.
+             */
+            int residualBlocksPerThread = 1000;
+
+            /**
+             * The relative decrease of the cost below which a solve converges.
+             */
+            double functionTolerance = 1e-6;
+
+            /**
+             * The maximal norm of the gradient below which a solve converges.
+             */
+            double gradientTolerance = 1e-10;
+
+            /**
+             * The relative change of the parameters below which a solve converges.
+             */
+            double parameterTolerance = 1e-8;
+
+            /**
+             * Writes the profile to the solver options.<br>
+             * The number of threads is set by the solve from its lease of the ThreadBudget.
+             */
+            void apply(ceres::Solver::Options &options) const;
+
+            /**
+             * @param numResidualBlocks The number of residual blocks of the problem.
+             *
+             * @return The number of threads a solve of the given size asks the ThreadBudget for, at least 1.
+             */
+            int getRequestedThreads(int numResidualBlocks) const;
+
+            /**
+             * @return true if the linear solver is based on the Schur complement, false else.
+             */
+            bool usesSchurComplement() const;
+
+            /**
+             * @return A short human readable description of the profile.
+             */
+            std::string toString() const;
+        };
+
+        /**
+         * The result of a single solve with a solver profile.
+         */
+        struct SolverProfileTiming {
+            /**
+             * The profile of the solve.
+             */
+            SolverProfile profile;
+
+            /**
+             * The fastest wall time of the repetitions in seconds.
+             */
+            double seconds;
+
+            /**
+             * The final cost of the solve.
+             */
+            double finalCost;
+        };
+
+        /**
+         * Creates the fixed set of candidates of the auto-tuning from the given profile.<br>
+         * The candidates vary the linear solver and the trust region strategy and keep the tolerances and limits.
+         *
+         * @param base The profile whose tolerances and limits are kept. It is the first candidate.
+         */
+        std::vector<SolverProfile> getAutotuneCandidates(const SolverProfile &base);
+
+        /**
+         * Selects the fastest timing that reaches the lowest final cost of all timings within the given tolerance.
+         *
+         * @param timings The timings of the candidates, not empty.
+         * @param relativeCostTolerance The tolerated relative difference to the lowest final cost.
+         *
+         * @return The fastest timing that reaches the lowest final cost.
+         */
+        const SolverProfileTiming &selectFastestProfile(const std::vector<SolverProfileTiming> &timings,
+                                                        double relativeCostTolerance = 1e-6);
+    }
+}
+
+#endif //STATICCALIBRATION_SOLVERPROFILE_HPP
@@ -0,0 +1,143 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#ifndef STATICCALIBRATION_THREADBUDGET_HPP
+#define STATICCALIBRATION_THREADBUDGET_HPP
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include "ceres/ceres.h"
+
+namespace static_calibration {
+    namespace calibration {
+
+        /**
+         * The process wide owner of the cores used by the solves.<br>
+         * Every solve leases its threads from the budget, so that concurrent solves, e.g. the parallel tries of an
+         * estimation or the estimations of several cameras, never run more threads than there are cores. All problems
+         * share one ceres context, so that the thread pool is not recreated for every problem.
+         */
+        class ThreadBudget {
+        public:
+            /**
+             * Threads leased from the budget, returned when the lease is destroyed.
+             */
+            class Lease {
+            private:
+                /**
+                 * The budget the threads are leased from, nullptr if the lease was moved.
+                 */
+                ThreadBudget *budget;
+
+                /**
+                 * The number of leased threads.
+                 */
+                int threads;
+
+            public:
+                /**
+                 * @constructor
+                 */
+                Lease(ThreadBudget *budget, int threads);
+
+                /**
+                 * @constructor
+                 */
+                Lease(Lease &&other) noexcept;
+
+                Lease(const Lease &) = delete;
+
+                Lease &operator=(const Lease &) = delete;
+
+                /**
+                 * @destructor Returns the threads to the budget.
+                 */
+                ~Lease();
+
+                /**
+                 * @get
+                 */
+                int getThreads() const;
+            };
+
+        private:
+            /**
+             * Guards the number of used threads.
+             */
+            std::mutex mutex;
+
+            /**
+             * Notified whenever threads are returned to the budget.
+             */
+            std::condition_variable released;
+
+            /**
+             * The number of threads of the budget.
+             */
+            int maxThreads;
+
+            /**
+             * The number of currently leased threads.
+             */
+            int usedThreads = 0;
+
+            /**
+             * The context shared by all problems.
+             */
+            std::unique_ptr<ceres::Context> context;
+
+            /**
+             * @constructor Uses all cores.
+             */
+            ThreadBudget();
+
+            /**
+             * Returns the given number of threads to the budget.
+             */
+            void release(int threads);
+
+        public:
+            /**
+             * @get The process wide budget.
+             */
+            static ThreadBudget &getInstance();
+
+            /**
+             * @set The number of threads of the budget, 0 to use all cores.
+             */
+            void setMaxThreads(int value);
+
+            /**
+             * @get
+             */
+            int getMaxThreads();
+
+            /**
+             * Splits the budget between the given number of concurrent jobs.<br>
+             * Many jobs run single threaded next to each other, a single job gets all threads.
+             *
+             * @return The number of threads per job, at least 1.
+             */
+            int getThreadsPerJob(int numJobs);
+
+            /**
+             * @get The context shared by all problems.
+             */
+            ceres::Context *getContext();
+
+            /**
+             * Leases up to the given number of threads.<br>
+             * Blocks until at least one thread is free, then leases as many of the free threads as requested.
+             *
+             * @param requestedThreads The maximal number of threads, at most the number of threads of the budget.
+             *
+             * @return The lease of at least one thread.
+             */
+            Lease acquire(int requestedThreads);
+        };
+    }
+}
+
+#endif //STATICCALIBRATION_THREADBUDGET_HPP
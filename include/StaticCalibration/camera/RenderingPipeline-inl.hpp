@@ -0,0 +1,212 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#ifndef STATICCALIBRATION_RENDERINGPIPELINE_INL_HPP
+#define STATICCALIBRATION_RENDERINGPIPELINE_INL_HPP
+
+#include <cmath>
+#include <limits>
+
+// Inline definitions of the rendering pipeline templates declared in RenderingPipeline.hpp.
+// The definitions live in the header so that they can be inlined into the automatic differentiation of the
+// residuals and instantiated for any scalar type, e.g. ceres::Jet of arbitrary width.
+
+namespace static_calibration {
+    namespace camera {
+
+        template<typename T>
+        inline std::vector<T> getIntrinsicsFromRealSensor(const T *intrinsics) {
+            T zero = (T) 0;
+
+            Eigen::Matrix<T, 2, 1> principalPoint = Eigen::Matrix<T, 2, 1>(
+                    intrinsics[3],
+                    intrinsics[4]
+            );
+
+            T focalLengthPXX = intrinsics[0] * (T) 1. / intrinsics[2];
+            T focalLengthPXY = intrinsics[1] * (T) 1. / intrinsics[2];
+
+            // TODO add skew
+
+            return
+                    std::vector<T>
+                            {
+                                    focalLengthPXX, focalLengthPXY, principalPoint(0, 0), principalPoint(1, 0), zero
+                            };
+        }
+
+        template<typename T>
+        inline Eigen::Matrix<T, 3, 4> getIntrinsicsMatrixFromConfig(const T *intrinsics) {
+            Eigen::Matrix<T, 3, 4> matrix;
+            T zero = T(0);
+            matrix <<
+                   intrinsics[0], intrinsics[1], intrinsics[2], zero,
+                    intrinsics[3], intrinsics[4], intrinsics[5], zero,
+                    intrinsics[6], intrinsics[7], intrinsics[8], zero;
+            return matrix;
+        }
+
+        template<typename T>
+        inline Eigen::Matrix<T, 3, 4> getIntrinsicsMatrix(const T *intrinsics, bool &invalid) {
+            T zero = (T) 0;
+            invalid = intrinsics[0] < zero;
+            invalid = false;
+            const T matrix[9] = {
+                    intrinsics[0], zero, intrinsics[2],
+                    zero, intrinsics[1], intrinsics[3],
+                    zero, zero, (T) 1
+            };
+            return getIntrinsicsMatrixFromConfig(matrix);
+        }
+
+        template<typename T>
+        inline Eigen::Matrix<T, 3, 4> getIntrinsicsMatrix(const T *intrinsics) {
+            bool invalid;
+            return getIntrinsicsMatrix(intrinsics, invalid);
+        }
+
+        template<typename T>
+        inline Eigen::Matrix<T, 2, 1> perspectiveDivision(const Eigen::Matrix<T, 3, 1> &vector, bool &flipped) {
+            flipped = vector[2] < (T) 0;
+            Eigen::Matrix<T, 3, 1> result = vector / (vector[2] + 1e-51);
+            return Eigen::Matrix<T, 2, 1>{result(0, 0), result(1, 0)};
+        }
+
+        template<typename T>
+        inline Eigen::Matrix<T, 3, 3> getCameraRotation(const T *rotation) {
+            using std::sin;
+            using std::cos;
+
+            const T toRadians = (T) (M_PI / 180);
+            const T a = -rotation[0] * toRadians;
+            const T b = -rotation[1] * toRadians;
+            const T c = rotation[2] * toRadians;
+
+            const T sinA = sin(a), cosA = cos(a);
+            const T sinB = sin(b), cosB = cos(b);
+            const T sinC = sin(c), cosC = cos(c);
+
+            // Z-flip * Rz(c) * Ry(b) * Rx(a)
+            Eigen::Matrix<T, 3, 3> rotationMatrix;
+            rotationMatrix <<
+                           cosC * cosB, cosC * sinB * sinA - sinC * cosA, cosC * sinB * cosA + sinC * sinA,
+                    sinC * cosB, sinC * sinB * sinA + cosC * cosA, sinC * sinB * cosA - cosC * sinA,
+                    sinB, -cosB * sinA, -cosB * cosA;
+            return rotationMatrix;
+        }
+
+        template<typename T>
+        inline Eigen::Matrix<T, 4, 4> getCameraRotationMatrix(const T *rotation) {
+            Eigen::Matrix<T, 4, 4> rotationMatrix = Eigen::Matrix<T, 4, 4>::Identity();
+            rotationMatrix.template block<3, 3>(0, 0) = getCameraRotation(rotation);
+            return rotationMatrix;
+        }
+
+        template<typename T>
+        inline Eigen::Matrix<T, 4, 1> toCameraSpace(const T *translation, const T *rotation, const T *vector) {
+            // The rotation is orthonormal, hence its inverse is the transpose.
+            const Eigen::Matrix<T, 3, 1> pointInCameraSpace = getCameraRotation<T>(rotation).transpose() *
+                                                              Eigen::Matrix<T, 3, 1>(
+                                                                      vector[0] - translation[0],
+                                                                      vector[1] - translation[1],
+                                                                      vector[2] - translation[2]);
+            return {pointInCameraSpace.x(), pointInCameraSpace.y(), pointInCameraSpace.z(), (T) 1};
+        }
+
+        template<typename T>
+        inline Eigen::Matrix<T, 3, 3> getCameraRotationFromAngleAxis(const T *angleAxis) {
+            using std::sin;
+            using std::cos;
+            using std::sqrt;
+
+            const T x = angleAxis[0], y = angleAxis[1], z = angleAxis[2];
+            const T thetaSquared = x * x + y * y + z * z;
+
+            // Rodrigues' formula, or its first order approximation close to the identity where the axis is undefined.
+            Eigen::Matrix<T, 3, 3> rotationMatrix;
+            if (thetaSquared > (T) std::numeric_limits<double>::epsilon()) {
+                const T theta = sqrt(thetaSquared);
+                const T kx = x / theta, ky = y / theta, kz = z / theta;
+                const T cosTheta = cos(theta), sinTheta = sin(theta);
+                const T oneMinusCos = (T) 1 - cosTheta;
+                rotationMatrix <<
+                               cosTheta + kx * kx * oneMinusCos,
+                        kx * ky * oneMinusCos - kz * sinTheta,
+                        kx * kz * oneMinusCos + ky * sinTheta,
+                        ky * kx * oneMinusCos + kz * sinTheta,
+                        cosTheta + ky * ky * oneMinusCos,
+                        ky * kz * oneMinusCos - kx * sinTheta,
+                        kz * kx * oneMinusCos - ky * sinTheta,
+                        kz * ky * oneMinusCos + kx * sinTheta,
+                        cosTheta + kz * kz * oneMinusCos;
+            } else {
+                rotationMatrix <<
+                               (T) 1, -z, y,
+                        z, (T) 1, -x,
+                        -y, x, (T) 1;
+            }
+
+            // Z-flip
+            rotationMatrix.row(2) = -rotationMatrix.row(2);
+            return rotationMatrix;
+        }
+
+        template<typename T>
+        inline Eigen::Matrix<T, 3, 1> getEulerAnglesFromAngleAxis(const T *angleAxis) {
+            using std::atan2;
+            using std::asin;
+
+            // Undo the Z-flip, the remainder is Rz(c) * Ry(b) * Rx(a) with a = -rx, b = -ry and c = rz.
+            Eigen::Matrix<T, 3, 3> rotationMatrix = getCameraRotationFromAngleAxis(angleAxis);
+            rotationMatrix.row(2) = -rotationMatrix.row(2);
+
+            const T toDegrees = (T) (180 / M_PI);
+            return {
+                    -atan2(rotationMatrix(2, 1), rotationMatrix(2, 2)) * toDegrees,
+                    asin(rotationMatrix(2, 0)) * toDegrees,
+                    atan2(rotationMatrix(1, 0), rotationMatrix(0, 0)) * toDegrees
+            };
+        }
+
+        template<typename T>
+        inline Eigen::Matrix<T, 2, 1> renderPose(const T *pose, const T *intrinsics, const T *vector, bool &flipped) {
+            const Eigen::Matrix<T, 3, 1> pointInCameraSpace = getCameraRotationFromAngleAxis(pose + 3).transpose() *
+                                                              Eigen::Matrix<T, 3, 1>(
+                                                                      vector[0] - pose[0],
+                                                                      vector[1] - pose[1],
+                                                                      vector[2] - pose[2]);
+            const Eigen::Matrix<T, 3, 1> homogeneousPixel{
+                    intrinsics[0] * pointInCameraSpace.x() + intrinsics[2] * pointInCameraSpace.z(),
+                    intrinsics[1] * pointInCameraSpace.y() + intrinsics[3] * pointInCameraSpace.z(),
+                    pointInCameraSpace.z()
+            };
+            return perspectiveDivision(homogeneousPixel, flipped);
+        }
+
+        template<typename T>
+        inline Eigen::Matrix<T, 2, 1>
+        render(const T *translation, const T *rotation, const T *intrinsics, const T *vector, bool &flipped) {
+            Eigen::Matrix<T, 4, 1> pointInCameraSpace = toCameraSpace(translation, rotation, vector);
+
+            bool invalid;
+            auto intrinsicsMatrix = getIntrinsicsMatrix(intrinsics, invalid);
+
+            Eigen::Matrix<T, 3, 1> homogeneousPixel = intrinsicsMatrix * pointInCameraSpace;
+
+            bool internalFlipped;
+            Eigen::Matrix<T, 2, 1> pixel = perspectiveDivision(homogeneousPixel, internalFlipped);
+            flipped = internalFlipped || invalid;
+            return pixel;
+        }
+
+        template<typename T>
+        inline Eigen::Matrix<T, 2, 1>
+        render(const T *translation, const T *rotation, const T *intrinsics, const T *vector) {
+            bool flipped;
+            return render(translation, rotation, intrinsics, vector, flipped);
+        }
+    }
+}
+
+#endif //STATICCALIBRATION_RENDERINGPIPELINE_INL_HPP
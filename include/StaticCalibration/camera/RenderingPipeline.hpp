@@ -7,6 +7,7 @@
 
 #include "Eigen/Dense"
 #include <vector>
+#include <limits>
 
 #include "CMakeConfig.h"
 
@@ -74,9 +75,25 @@ namespace static_calibration {
         template<typename T>
         Eigen::Matrix<T, 2, 1> perspectiveDivision(const Eigen::Matrix<T, 3, 1> &vector, bool &flipped);
 
+        /**
+         * Generates the 3x3 camera rotation matrix from the euler angle representation.<br>
+         * Evaluates the sine and cosine of every angle once and assembles the concatenated rotations around the
+         * X/Y/Z axis in closed form.<br>
+         * Assumes a camera with no rotation to have a coordinate system of [X/Y/-Z].<br>
+         *
+         * @link https://en.wikipedia.org/wiki/Rotation_matrix#In_three_dimensions
+         *
+         * @tparam T double or ceres::Jet
+         * @param rotation The [x, y, z] euler angle rotation.
+         *
+         * @return The complete rotation around the three axis.
+         */
+        template<typename T>
+        Eigen::Matrix<T, 3, 3> getCameraRotation(const T *rotation);
+
         /**
          * Generates a camera rotation matrix from the euler angle representation.<br>
-         * Internally creates the matrices for a rotation around the X/Y/Z axis and concatenates them.<br>
+         * Embeds the 3x3 rotation in homogeneous coordinates.<br>
          * Assumes a camera with no rotation to have a coordinate system of [X/Y/-Z].<br>
          *
          * @link https://en.wikipedia.org/wiki/Rotation_matrix#In_three_dimensions
@@ -121,6 +138,341 @@ namespace static_calibration {
         Eigen::Matrix<T, 2, 1>
         render(const T *translation, const T *rotation, const T *intrinsics, const T *vector, bool &flipped);
 
+        /**
+         * Generates the 3x3 camera rotation matrix from the angle axis representation.<br>
+         * The angle axis rotates the camera axis into the world axis, the additional flip of the world Z-axis gives
+         * the camera coordinate system of [X/Y/-Z] as in getCameraRotation.
+         *
+         * @tparam T double or ceres::Jet
+         * @param angleAxis The [x, y, z] angle axis rotation in radians.
+         *
+         * @return The complete rotation around the three axis.
+         */
+        template<typename T>
+        Eigen::Matrix<T, 3, 3> getCameraRotationFromAngleAxis(const T *angleAxis);
+
+        /**
+         * Converts the angle axis rotation of the camera to the [x, y, z] euler angle rotation used by
+         * getCameraRotation.
+         *
+         * @tparam T double or ceres::Jet
+         * @param angleAxis The [x, y, z] angle axis rotation in radians.
+         *
+         * @return The [x, y, z] euler angle rotation in degrees.
+         */
+        template<typename T>
+        Eigen::Matrix<T, 3, 1> getEulerAnglesFromAngleAxis(const T *angleAxis);
+
+        /**
+         * Converts the [x, y, z] euler angle rotation of the camera to the angle axis representation.
+         *
+         * @param rotation The [x, y, z] euler angle rotation in degrees.
+         *
+         * @return The [x, y, z] angle axis rotation in radians.
+         */
+        Eigen::Vector3d getAngleAxisFromEulerAngles(const double *rotation);
+
+        /**
+         * Creates the 6-DoF camera pose used as a single parameter block during optimization.
+         *
+         * @param translation The [x, y, z] translation of the camera in world space.
+         * @param rotation The [x, y, z] euler angle rotation of the camera around the world axis.
+         *
+         * @return The [tx, ty, tz, ax, ay, az] pose with the rotation in angle axis representation.
+         */
+        Eigen::Matrix<double, 6, 1> getPose(const double *translation, const double *rotation);
+
+        /**
+         * Wrapper for the whole rendering pipeline based on the 6-DoF camera pose.
+         *
+         * @tparam T double or ceres::Jet
+         * @param pose The [tx, ty, tz, ax, ay, az] pose of the camera in world space.
+         * @param intrinsics [fx, fy, cx, cy, skew]
+         * @param vector The [x, y, z] vector in world space.
+         * @param flipped Output flag if the vector is behind the camera.
+         *
+         * @return The [u, v] pixel location in image space.
+         */
+        template<typename T>
+        Eigen::Matrix<T, 2, 1> renderPose(const T *pose, const T *intrinsics, const T *vector, bool &flipped);
+
+        /**
+         * Renders the given vector and calculates the analytic jacobians of the pixel with respect to the camera
+         * pose, the intrinsics and the vector.<br>
+         * The jacobians are only calculated if the corresponding output is not null.
+         *
+         * @param pose The [tx, ty, tz, ax, ay, az] pose of the camera in world space.
+         * @param intrinsics [fx, fy, cx, cy, skew]
+         * @param vector The [x, y, z] vector in world space.
+         * @param flipped Output flag if the vector is behind the camera.
+         * @param jacobianPose [Optional] The jacobian of the pixel with respect to the pose.
+         * @param jacobianIntrinsics [Optional] The jacobian of the pixel with respect to [fx, fy, cx, cy].
+         * @param jacobianVector [Optional] The jacobian of the pixel with respect to the vector.
+         *
+         * @return The [u, v] pixel location in image space.
+         */
+        Eigen::Vector2d renderWithJacobians(const double *pose, const double *intrinsics, const double *vector,
+                                            bool &flipped,
+                                            Eigen::Matrix<double, 2, 6> *jacobianPose,
+                                            Eigen::Matrix<double, 2, 4> *jacobianIntrinsics,
+                                            Eigen::Matrix<double, 2, 3> *jacobianVector);
+
+        /**
+         * The parts of the camera transformation that only depend on the pose.<br>
+         * Calculated once and shared by all points that are rendered with the same pose.
+         */
+        struct PoseTransform {
+            /**
+             * The [tx, ty, tz] translation of the camera in world space.
+             */
+            Eigen::Vector3d translation;
+
+            /**
+             * The camera rotation, i.e. the Z-flip times the rotation of the angle axis.
+             */
+            Eigen::Matrix3d rotation;
+
+            /**
+             * The right jacobian of SO(3) at the angle axis of the pose.
+             */
+            Eigen::Matrix3d rightJacobian;
+        };
+
+        /**
+         * @get The pose dependent parts of the camera transformation.
+         *
+         * @param pose The [tx, ty, tz, ax, ay, az] pose of the camera in world space.
+         * @param withJacobian Flag if the right jacobian is calculated, it is left uninitialized otherwise.
+         */
+        PoseTransform getPoseTransform(const double *pose, bool withJacobian = true);
+
+        /**
+         * Renders the given vector and calculates the analytic jacobians using the precalculated pose transform.
+         *
+         * @see renderWithJacobians
+         */
+        Eigen::Vector2d renderWithJacobians(const PoseTransform &transform, const double *intrinsics,
+                                            const double *vector, bool &flipped,
+                                            Eigen::Matrix<double, 2, 6> *jacobianPose,
+                                            Eigen::Matrix<double, 2, 4> *jacobianIntrinsics,
+                                            Eigen::Matrix<double, 2, 3> *jacobianVector);
+
+        /**
+         * The viewing frustum used to cull projected points.
+         */
+        struct Frustum {
+            /**
+             * The minimal depth in camera space of a visible point.
+             */
+            double nearPlane = 0;
+
+            /**
+             * The maximal depth in camera space of a visible point.
+             */
+            double farPlane = std::numeric_limits<double>::infinity();
+
+            /**
+             * The width of the image. Points are not culled horizontally if not positive.
+             */
+            int imageWidth = 0;
+
+            /**
+             * The height of the image. Points are not culled vertically if not positive.
+             */
+            int imageHeight = 0;
+
+            /**
+             * @constructor
+             */
+            Frustum() = default;
+
+            /**
+             * @constructor
+             *
+             * @param nearPlane The minimal depth in camera space of a visible point.
+             * @param farPlane The maximal depth in camera space of a visible point.
+             * @param imageWidth The width of the image.
+             * @param imageHeight The height of the image.
+             */
+            Frustum(double nearPlane, double farPlane, int imageWidth = 0, int imageHeight = 0);
+        };
+
+        /**
+         * The pixels, depths and visibility flags of a batch of projected points stored as structure of arrays.
+         */
+        struct ProjectedPoints {
+            /**
+             * The horizontal pixel locations.
+             */
+            Eigen::ArrayXd u;
+
+            /**
+             * The vertical pixel locations.
+             */
+            Eigen::ArrayXd v;
+
+            /**
+             * The depths of the points in camera space.
+             */
+            Eigen::ArrayXd depth;
+
+            /**
+             * Flags if the points are inside the frustum, i.e. between the near and far plane and inside the image.
+             */
+            Eigen::Array<bool, Eigen::Dynamic, 1> visible;
+
+            /**
+             * @get The number of projected points.
+             */
+            int size() const;
+
+            /**
+             * @get The [u, v] pixel location of the i-th point.
+             */
+            Eigen::Vector2d getPixel(int i) const;
+        };
+
+        /**
+         * Projects a batch of points with one camera pose and culls them against the frustum.<br>
+         * The points are given as structure of arrays so that the whole batch is processed with vectorized array
+         * operations. Every point is transformed once for its depth, pixel and visibility. The pixels are equivalent
+         * to calling render for every point.
+         *
+         * @param translation The [x, y, z] translation of the camera in world space.
+         * @param rotation The [x, y, z] euler angle rotation of the camera around the world axis.
+         * @param intrinsics [fx, fy, cx, cy, skew]
+         * @param x The x coordinates of the points in world space.
+         * @param y The y coordinates of the points in world space.
+         * @param z The z coordinates of the points in world space.
+         * @param numberOfPoints The length of the input and output arrays.
+         * @param u The output horizontal pixel locations.
+         * @param v The output vertical pixel locations.
+         * @param depth The output depths of the points in camera space.
+         * @param visible The output flags if the points are inside the frustum.
+         * @param frustum The frustum used for culling. Defaults to all points in front of the camera.
+         */
+        void projectPoints(const double *translation, const double *rotation, const double *intrinsics,
+                           const double *x, const double *y, const double *z, int numberOfPoints,
+                           double *u, double *v, double *depth, bool *visible, const Frustum &frustum = Frustum());
+
+        /**
+         * @overload
+         *
+         * @param points The [x, y, z] points in world space. The column major storage holds the x, y and z
+         * coordinates as contiguous arrays.
+         */
+        ProjectedPoints projectPoints(const double *translation, const double *rotation, const double *intrinsics,
+                                      const Eigen::Matrix<double, Eigen::Dynamic, 3> &points,
+                                      const Frustum &frustum = Frustum());
+
+        /**
+         * A batch of world positions stored in single precision relative to a local origin.<br>
+         * At the ~800 m offsets of the world coordinates single precision only resolves a few centimeters, hence the
+         * positions are shifted into a local frame around their mean before the conversion.
+         */
+        struct LocalPoints {
+            /**
+             * The origin of the local frame in world space.
+             */
+            Eigen::Vector3d origin;
+
+            /**
+             * The x coordinates of the points relative to the origin.
+             */
+            Eigen::ArrayXf x;
+
+            /**
+             * The y coordinates of the points relative to the origin.
+             */
+            Eigen::ArrayXf y;
+
+            /**
+             * The z coordinates of the points relative to the origin.
+             */
+            Eigen::ArrayXf z;
+
+            /**
+             * @constructor
+             *
+             * @param points The [x, y, z] points in world space.
+             */
+            explicit LocalPoints(const Eigen::Matrix<double, Eigen::Dynamic, 3> &points);
+
+            /**
+             * @get The number of points.
+             */
+            int size() const;
+        };
+
+        /**
+         * The single precision pixels, depths and visibility flags of a batch of projected points.
+         */
+        struct ProjectedPointsf {
+            /**
+             * The horizontal pixel locations.
+             */
+            Eigen::ArrayXf u;
+
+            /**
+             * The vertical pixel locations.
+             */
+            Eigen::ArrayXf v;
+
+            /**
+             * The depths of the points in camera space.
+             */
+            Eigen::ArrayXf depth;
+
+            /**
+             * Flags if the points are inside the frustum, i.e. between the near and far plane and inside the image.
+             */
+            Eigen::Array<bool, Eigen::Dynamic, 1> visible;
+
+            /**
+             * @get The number of projected points.
+             */
+            int size() const;
+
+            /**
+             * @get The [u, v] pixel location of the i-th point.
+             */
+            Eigen::Vector2d getPixel(int i) const;
+        };
+
+        /**
+         * Projects a batch of points in single precision.<br>
+         * Twice as many points fit into a SIMD register and the arrays need half the memory bandwidth of the double
+         * precision batch. Only meant for screening candidates and rendering, i.e. where pixel accuracy suffices.
+         * The optimization stays in double precision.
+         *
+         * @param translation The [x, y, z] translation of the camera relative to the origin of the points.
+         * @param rotation The [x, y, z] euler angle rotation of the camera around the world axis.
+         * @param intrinsics [fx, fy, cx, cy, skew]
+         * @param x The x coordinates of the points relative to their origin.
+         * @param y The y coordinates of the points relative to their origin.
+         * @param z The z coordinates of the points relative to their origin.
+         * @param numberOfPoints The length of the input and output arrays.
+         * @param u The output horizontal pixel locations.
+         * @param v The output vertical pixel locations.
+         * @param depth The output depths of the points in camera space.
+         * @param visible The output flags if the points are inside the frustum.
+         * @param frustum The frustum used for culling. Defaults to all points in front of the camera.
+         */
+        void projectPoints(const float *translation, const double *rotation, const double *intrinsics,
+                           const float *x, const float *y, const float *z, int numberOfPoints,
+                           float *u, float *v, float *depth, bool *visible, const Frustum &frustum = Frustum());
+
+        /**
+         * @overload
+         *
+         * @param translation The [x, y, z] translation of the camera in world space.
+         * @param points The points in single precision relative to their local origin.
+         */
+        ProjectedPointsf projectPoints(const double *translation, const double *rotation, const double *intrinsics,
+                                       const LocalPoints &points, const Frustum &frustum = Frustum());
     }
 }
+
+#include "StaticCalibration/camera/RenderingPipeline-inl.hpp"
+
 #endif //CAMERASTABILIZATION_RENDERINGPIPELINE_HPP
@@ -5,8 +5,11 @@
 #ifndef STATICCALIBRATION_DATASET_HPP
 #define STATICCALIBRATION_DATASET_HPP
 
+#include <cstdint>
 #include <vector>
 #include <map>
+#include <memory>
+#include <random>
 #include <opencv2/opencv.hpp>
 #include <StaticCalibration/camera/RenderingPipeline.hpp>
 #include <StaticCalibration/residuals/CorrespondenceResidual.hpp>
@@ -57,11 +60,56 @@ namespace static_calibration {
              */
             std::vector<calibration::ParametricPoint> explicitRoadMarksParametricPoints;
 
+            /**
+             * The [begin, end) ranges of the world object parametric points that belong to the same mapping entry.
+             */
+            std::vector<std::pair<int, int>> worldObjectsParametricPointGroups;
+
+            /**
+             * The [begin, end) ranges of the explicit road mark parametric points that belong to the same mapping entry.
+             */
+            std::vector<std::pair<int, int>> explicitRoadMarksParametricPointGroups;
+
+            /**
+             * The contiguous storage of the lambdas of the parametric points, one buffer per mapping entry.<br>
+             * Shared with copies of the dataset, as the parametric points only hold pointers to their lambdas.
+             */
+            std::vector<std::shared_ptr<std::vector<double>>> lambdas;
+
+            /**
+             * The [world object id, image object id] mapping entries of the lambda buffers.
+             */
+            std::vector<std::pair<std::string, std::string>> lambdaKeys;
+
+            /**
+             * Only every rowStride-th row of the center lines of the image objects becomes a parametric point.
+             */
+            int rowStride = 1;
+
+            /**
+             * The maximal number of parametric points per mapping entry, 0 for no limit.
+             */
+            int maxPointsPerEntry = 0;
+
+            /**
+             * @get The center line of the image object subsampled by the row stride and the maximal number of points.
+             */
+            std::vector<Eigen::Vector2d> getCenterLine(int imageObjectIndex) const;
+
             /**
              * Merges the 3D world objects with the 2D image objects.
              */
             void merge();
 
+            /**
+             * Removes the parametric points and the lambdas of the given mapping entry.
+             *
+             * @param entry The [world object id, image object id] mapping entry.
+             * @param removedLambdas The list to add the lambda buffers of the removed parametric points to.
+             */
+            void unmerge(const std::pair<std::string, std::string> &entry,
+                         std::vector<std::shared_ptr<std::vector<double>>> &removedLambdas);
+
         public:
 
             /**
@@ -125,6 +173,7 @@ namespace static_calibration {
              *                              Keep this as small as possible as the time complexity for subset generation is in worst case O(n * 2^n)
              * @param maxElementsPerMapping The maximal number of elements per mapping.
              *                              Keep this as small as possible as the time complexity for subset generation is in worst case O(n * 2^n)
+             * @param seed The seed of the shuffle of the mappings.
              *
              * @return All possible mappings.
              */
@@ -132,7 +181,7 @@ namespace static_calibration {
             createAllMappings(const Eigen::Vector3d &translation, const Eigen::Vector3d &rotation,
                               const std::vector<double> &intrinsics, int maxDistance, int maxElementsInDistance,
                               int maxElementsPerMapping = -1, bool sort = true, bool keepOnlyLongest = true,
-                              bool shuffle = true);
+                              bool shuffle = true, std::uint64_t seed = std::default_random_engine::default_seed);
 
             /**
              * @get
@@ -146,6 +195,13 @@ namespace static_calibration {
             template<typename T>
             const std::vector<calibration::ParametricPoint> &getParametricPoints() const;
 
+            /**
+             * @get The [begin, end) ranges of the parametric points that originate from the same world object and
+             * image object pair. The lambdas of the points of a range are stored contiguously.
+             */
+            template<typename T>
+            const std::vector<std::pair<int, int>> &getParametricPointGroups() const;
+
 
             /**
              * @set
@@ -154,7 +210,15 @@ namespace static_calibration {
 
             const std::map<std::string, std::string> &getMappingExtension() const;
 
-            void setMappingExtension(const std::map<std::string, std::string> &mappingExtension);
+            /**
+             * @set Only the parametric points of the mapping entries that enter or leave the merged mapping are added
+             * or removed. The parametric points and lambdas of all other entries stay in place.
+             *
+             * @return The lambda buffers of the removed parametric points. They stay valid as long as they are held,
+             * so that no added lambda reuses the storage of a removed one that is still referenced elsewhere.
+             */
+            std::vector<std::shared_ptr<std::vector<double>>>
+            setMappingExtension(const std::map<std::string, std::string> &mappingExtension);
 
             std::map<std::string, std::string> getMergedMappings() const;
 
@@ -184,6 +248,41 @@ namespace static_calibration {
              */
             void clear();
 
+            /**
+             * Moves the lambdas of the parametric points into storage owned by this dataset only.<br>
+             * The lambdas are shared with the copies of the dataset otherwise, which prevents independent
+             * optimizations on the copies.
+             */
+            void detachLambdas();
+
+            /**
+             * Creates a copy of the dataset with fewer parametric points per mapping entry.<br>
+             * Neighbouring rows of the center lines yield nearly redundant correspondences, hence a solve on the copy
+             * is a cheap approximation of the solve on the full dataset.
+             *
+             * @param rowStride Only every rowStride-th row of the center lines becomes a parametric point.
+             * @param maxPointsPerEntry The maximal number of parametric points per mapping entry, 0 for no limit.
+             *
+             * @return The subsampled copy with its own lambdas.
+             */
+            DataSet subsample(int rowStride, int maxPointsPerEntry) const;
+
+            /**
+             * @get The lambdas of the parametric points per [world object id, image object id] mapping entry.
+             */
+            std::map<std::pair<std::string, std::string>, std::vector<double>> getLambdas() const;
+
+            /**
+             * Sets the lambdas of the mapping entries that are in the given lambdas with the same number of points.
+             * <br>
+             * The lambdas of all other mapping entries are not changed.
+             *
+             * @param values The lambdas per [world object id, image object id] mapping entry.
+             *
+             * @return The number of mapping entries whose lambdas were set.
+             */
+            int setLambdas(const std::map<std::pair<std::string, std::string>, std::vector<double>> &values);
+
             template<typename T>
             void merge(int worldObjectIndex, int imageObjectIndex);
 
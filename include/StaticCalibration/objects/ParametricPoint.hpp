@@ -53,6 +53,15 @@ namespace static_calibration {
             ParametricPoint(Eigen::Matrix<double, 2, 1> expectedPixel, Eigen::Matrix<double, 3, 1> origin,
                             const Eigen::Matrix<double, 3, 1> &axisA, double lambdaMax);
 
+            /**
+             * @constructor
+             *
+             * @param lambdaMax The maximal distance from the origin in the first axis.
+             * @param lambda The externally owned storage of the distance from the origin in the first axis.
+             */
+            ParametricPoint(Eigen::Matrix<double, 2, 1> expectedPixel, Eigen::Matrix<double, 3, 1> origin,
+                            const Eigen::Matrix<double, 3, 1> &axisA, double lambdaMax, double *lambda);
+
             ParametricPoint(Eigen::Matrix<double, 2, 1> expectedPixel, Eigen::Matrix<double, 3, 1> origin);
 
             /**
@@ -80,6 +89,11 @@ namespace static_calibration {
              */
             double *getLambda() const;
 
+            /**
+             * @set The externally owned storage of the distance from the origin in the first axis.
+             */
+            void setLambda(double *lambda);
+
             /**
              * @get
              */
@@ -0,0 +1,64 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#ifndef STATICCALIBRATION_ANALYTICCORRESPONDENCERESIDUAL_HPP
+#define STATICCALIBRATION_ANALYTICCORRESPONDENCERESIDUAL_HPP
+
+#include "Eigen/Dense"
+#include "ceres/ceres.h"
+#include "StaticCalibration/objects/ParametricPoint.hpp"
+#include "StaticCalibration/residuals/CorrespondenceResidualBase.hpp"
+
+namespace static_calibration {
+    namespace calibration {
+        namespace residuals {
+
+            /**
+             * The correspondence residual with fixed intrinsics and hand derived jacobians.<br>
+             * Calculates the same residuals as the CorrespondenceResidual without carrying Jets through the
+             * rendering pipeline.
+             */
+            class AnalyticCorrespondenceResidual
+                    : public CorrespondenceResidualBase,
+                      public ceres::SizedCostFunction<2, 6, 1> {
+            protected:
+                /**
+                 * The intrinsic camera parameters used to project the point.
+                 */
+                std::vector<double> intrinsics;
+
+            public:
+                /**
+                 * @constructor
+                 *
+                 * @param expectedPixel The expected [u, v] pixel location.
+                 * @param point The [x, y, z] point that corresponds to the pixel.
+                 * @param intrinsics The intrinsics of the pinhole camera model.
+                 */
+                AnalyticCorrespondenceResidual(Eigen::Matrix<double, 2, 1> expectedPixel,
+                                               const ParametricPoint &point, std::vector<double> intrinsics);
+
+                /**
+                 * @destructor
+                 */
+                ~AnalyticCorrespondenceResidual() override = default;
+
+                /**
+                 * Calculates the residual error and the jacobians with respect to the parameter blocks
+                 * [pose, lambda].
+                 */
+                bool Evaluate(double const *const *parameters, double *residuals, double **jacobians) const override;
+
+                /**
+                 * Factory method to hide the residual creation.
+                 */
+                static ceres::CostFunction *
+                create(const Eigen::Matrix<double, 2, 1> &expectedPixel, const ParametricPoint &point,
+                       const std::vector<double> &intrinsics);
+            };
+        }
+    }
+}
+
+#endif //STATICCALIBRATION_ANALYTICCORRESPONDENCERESIDUAL_HPP
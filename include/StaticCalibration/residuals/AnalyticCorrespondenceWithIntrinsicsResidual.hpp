@@ -0,0 +1,56 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#ifndef STATICCALIBRATION_ANALYTICCORRESPONDENCEWITHINTRINSICSRESIDUAL_HPP
+#define STATICCALIBRATION_ANALYTICCORRESPONDENCEWITHINTRINSICSRESIDUAL_HPP
+
+#include "Eigen/Dense"
+#include "ceres/ceres.h"
+#include "StaticCalibration/objects/ParametricPoint.hpp"
+#include "StaticCalibration/residuals/CorrespondenceResidualBase.hpp"
+
+namespace static_calibration {
+    namespace calibration {
+        namespace residuals {
+
+            /**
+             * The correspondence residual with optimized intrinsics and hand derived jacobians.<br>
+             * Calculates the same residuals as the CorrespondenceWithIntrinsicsResidual without carrying Jets
+             * through the rendering pipeline.
+             */
+            class AnalyticCorrespondenceWithIntrinsicsResidual
+                    : public CorrespondenceResidualBase,
+                      public ceres::SizedCostFunction<3, 4, 6, 1> {
+            public:
+                /**
+                 * @constructor
+                 *
+                 * @param expectedPixel The expected [u, v] pixel location.
+                 * @param point The [x, y, z] point that corresponds to the pixel.
+                 */
+                AnalyticCorrespondenceWithIntrinsicsResidual(Eigen::Matrix<double, 2, 1> expectedPixel,
+                                                             const ParametricPoint &point);
+
+                /**
+                 * @destructor
+                 */
+                ~AnalyticCorrespondenceWithIntrinsicsResidual() override = default;
+
+                /**
+                 * Calculates the residual error and the jacobians with respect to the parameter blocks
+                 * [intrinsics, pose, lambda].
+                 */
+                bool Evaluate(double const *const *parameters, double *residuals, double **jacobians) const override;
+
+                /**
+                 * Factory method to hide the residual creation.
+                 */
+                static ceres::CostFunction *create(const Eigen::Matrix<double, 2, 1> &expectedPixel,
+                                                   const ParametricPoint &point);
+            };
+        }
+    }
+}
+
+#endif //STATICCALIBRATION_ANALYTICCORRESPONDENCEWITHINTRINSICSRESIDUAL_HPP
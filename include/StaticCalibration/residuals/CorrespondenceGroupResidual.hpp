@@ -0,0 +1,157 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#ifndef STATICCALIBRATION_CORRESPONDENCEGROUPRESIDUAL_HPP
+#define STATICCALIBRATION_CORRESPONDENCEGROUPRESIDUAL_HPP
+
+#include <memory>
+#include <vector>
+#include "Eigen/Dense"
+#include "ceres/ceres.h"
+#include "StaticCalibration/objects/ParametricPoint.hpp"
+#include "StaticCalibration/camera/RenderingPipeline.hpp"
+#include "StaticCalibration/residuals/PoseTransformCache.hpp"
+
+namespace static_calibration {
+    namespace calibration {
+        namespace residuals {
+
+            /**
+             * The correspondence residuals of a group of points in a single residual block.<br>
+             * The points originate from the same image object and world object pair. Their lambdas are stored
+             * contiguously and form one parameter block. The pixel errors are scaled by fixed per point weights that
+             * the outlier rejection sets between solves. The camera transform is calculated once for the whole group
+             * and the loss function is applied per point.<br>
+             * The parameter blocks are [intrinsics (optional), pose, lambdas].
+             */
+            class CorrespondenceGroupResidual : public ceres::CostFunction {
+            protected:
+                /**
+                 * The maximal number of parameter blocks of a single point, i.e. [intrinsics, pose, lambda].
+                 */
+                static constexpr int maxPointBlocks = 3;
+
+                /**
+                 * The maximal size of a parameter block of a single point, i.e. the pose.
+                 */
+                static constexpr int maxPointBlockSize = 6;
+
+                /**
+                 * The maximal number of residuals of a single point, i.e. [u, v] and the intrinsics error.
+                 */
+                static constexpr int maxResidualsPerPoint = 3;
+
+                /**
+                 * The parametric points of the group.
+                 */
+                std::vector<ParametricPoint> points;
+
+                /**
+                 * The fixed intrinsics of the pinhole camera model. Empty if the intrinsics are optimized.
+                 */
+                std::vector<double> intrinsics;
+
+                /**
+                 * The contiguous fixed weights of the points, nullptr for unit weights.
+                 */
+                const double *weights;
+
+                /**
+                 * The loss function applied to the residuals of every single point.
+                 */
+                std::unique_ptr<ceres::LossFunction> lossFunction;
+
+                /**
+                 * Flag if the hand derived jacobians are used instead of the automatic differentiation.
+                 */
+                bool analyticJacobians;
+
+                /**
+                 * The optional per iteration cache of the camera transform used by the hand derived jacobians.
+                 */
+                const PoseTransformCache *poseTransformCache;
+
+                /**
+                 * The automatically differentiated residuals of the single points.
+                 */
+                std::vector<std::unique_ptr<ceres::CostFunction>> pointResiduals;
+
+                /**
+                 * The number of residuals per point, i.e. the [u, v] pixel error and the optional intrinsics error.
+                 */
+                int residualsPerPoint;
+
+                /**
+                 * The parameter block sizes of a single point residual.
+                 */
+                std::vector<int> pointBlockSizes;
+
+                /**
+                 * @get Flag if the intrinsics are optimized.
+                 */
+                bool hasIntrinsicsBlock() const;
+
+                /**
+                 * Calculates the residuals of a single point and the jacobians with respect to the parameter blocks of
+                 * the point, i.e. [intrinsics (optional), pose, lambda].
+                 */
+                bool evaluatePoint(int index, double const *const *parameters,
+                                   const static_calibration::camera::PoseTransform &transform,
+                                   double *residuals, double **jacobians) const;
+
+                /**
+                 * Scales the [u, v] pixel error of a single point and its jacobians by the given weight.
+                 */
+                void applyWeight(double weight, double *residuals, double **jacobians) const;
+
+            public:
+                /**
+                 * @constructor
+                 *
+                 * @param points The parametric points of the group.
+                 * @param intrinsics The fixed intrinsics of the pinhole camera model. Empty if the intrinsics are
+                 * optimized.
+                 * @param weights The contiguous fixed weights of the points, nullptr for unit weights. Read at every
+                 * evaluation, hence they may change between solves.
+                 * @param lossFunction The loss function applied per point. Ownership is taken.
+                 * @param analyticJacobians Flag if the hand derived jacobians are used.
+                 * @param poseTransformCache The optional cache of the camera transform.
+                 */
+                CorrespondenceGroupResidual(std::vector<ParametricPoint> points, std::vector<double> intrinsics,
+                                            const double *weights, ceres::LossFunction *lossFunction,
+                                            bool analyticJacobians,
+                                            const PoseTransformCache *poseTransformCache = nullptr);
+
+                /**
+                 * @destructor
+                 */
+                ~CorrespondenceGroupResidual() override = default;
+
+                /**
+                 * Calculates the residual errors of all points and the jacobians with respect to the parameter blocks.
+                 */
+                bool Evaluate(double const *const *parameters, double *residuals, double **jacobians) const override;
+
+                /**
+                 * Factory method to hide the residual creation for fixed intrinsics.
+                 */
+                static ceres::CostFunction *create(const std::vector<ParametricPoint> &points,
+                                                   const std::vector<double> &intrinsics, const double *weights,
+                                                   ceres::LossFunction *lossFunction, bool analyticJacobians,
+                                                   const PoseTransformCache *poseTransformCache = nullptr);
+
+                /**
+                 * Factory method to hide the residual creation for optimized intrinsics.
+                 */
+                static ceres::CostFunction *createWithIntrinsics(const std::vector<ParametricPoint> &points,
+                                                                 const double *weights,
+                                                                 ceres::LossFunction *lossFunction,
+                                                                 bool analyticJacobians,
+                                                                 const PoseTransformCache *poseTransformCache = nullptr);
+            };
+        }
+    }
+}
+
+#endif //STATICCALIBRATION_CORRESPONDENCEGROUPRESIDUAL_HPP
@@ -45,24 +45,13 @@ namespace static_calibration {
                  * Calculates the residual error after transforming the world position to a pixel.
                  *
                  * @tparam T Template parameter expected from the ceres-solver.
-                 * @param translation The [x, y, z] translation of the camera in world space for which we optimize.
-                 * @param rotation The [x, y, z] euler angle rotation of the camera around the world axis for which we optimize.
+                 * @param pose The [tx, ty, tz, ax, ay, az] pose of the camera in world space for which we optimize.
                  * @param lambda The [l] distance of the point in the direction of one side of the parametricPoint from the origin.
                  * @param residual The [u, v] pixel error between the expected and calculated pixel.
                  * @return true
                  */
                 template<typename T>
-                bool operator()(
-                        const T *tx,
-                        const T *ty,
-                        const T *tz,
-                        const T *rx,
-                        const T *ry,
-                        const T *rz,
-                        const T *lambda,
-                        const T *weight,
-                        T *residual)
-                const;
+                bool operator()(const T *pose, const T *lambda, T *residual) const;
 
                 /**
                  * Factory method to hide the residual creation.
@@ -37,6 +37,11 @@ namespace static_calibration {
                  */
                 std::string name;
 
+                /**
+                 * The index of the constrained value within the parameter block.
+                 */
+                int index = 0;
+
             public:
 
                 /**
@@ -56,6 +61,16 @@ namespace static_calibration {
                  */
                 DistanceFromIntervalResidual(double lowerBound, double upperBound, std::string name = "");
 
+                /**
+                 * @constructor
+                 *
+                 * @param index The index of the constrained value within the parameter block.
+                 * @param lowerBound The lower bound of the interval.
+                 * @param upperBound The upper bound of the interval.
+                 * @param name An optional name for debug.
+                 */
+                DistanceFromIntervalResidual(int index, double lowerBound, double upperBound, std::string name = "");
+
                 /**
                  * @destructor
                  */
@@ -66,7 +81,7 @@ namespace static_calibration {
                  *
                  * @tparam T double or ceres::Jet<double, 1>
                  *
-                 * @param value The current estimated value.
+                 * @param value The current estimated parameter block.
                  * @param residual The residual, i.e. f(x, l, u)
                  *
                  * @return true
@@ -94,6 +109,20 @@ namespace static_calibration {
                  * @return The cost function based on the residual.
                  */
                 static ceres::CostFunction *create(double lowerBound, double upperBound, std::string name = "");
+
+                /**
+                 * Factory method to ease residual creation for one of the [fx, fy, cx, cy] values of the intrinsics
+                 * parameter block.
+                 *
+                 * @param index The index of the constrained value within the intrinsics.
+                 * @param lowerBound The lower bound of the interval.
+                 * @param upperBound The upper bound of the interval.
+                 * @param name An optional name for debug.
+                 *
+                 * @return The cost function based on the residual.
+                 */
+                static ceres::CostFunction *
+                createForIntrinsics(int index, double lowerBound, double upperBound, std::string name = "");
             };
 
         }
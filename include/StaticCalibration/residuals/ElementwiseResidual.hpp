@@ -0,0 +1,71 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#ifndef STATICCALIBRATION_ELEMENTWISERESIDUAL_HPP
+#define STATICCALIBRATION_ELEMENTWISERESIDUAL_HPP
+
+#include <memory>
+#include <vector>
+#include "ceres/ceres.h"
+
+namespace static_calibration {
+    namespace calibration {
+        namespace residuals {
+
+            /**
+             * Applies one scalar residual to every element of a parameter block in a single residual block.<br>
+             * Used for the lambda priors of a group of points whose lambdas are stored contiguously.
+             * The loss function is applied per element.
+             */
+            class ElementwiseResidual : public ceres::CostFunction {
+            protected:
+                /**
+                 * The residuals of the single elements with one residual and one parameter block of size 1.
+                 */
+                std::vector<std::unique_ptr<ceres::CostFunction>> elementResiduals;
+
+                /**
+                 * The loss function applied to the residual of every single element.
+                 */
+                ceres::LossFunction *lossFunction;
+
+                /**
+                 * The owned loss function, empty if the loss function is shared with other residuals.
+                 */
+                std::unique_ptr<ceres::LossFunction> ownedLossFunction;
+
+            public:
+                /**
+                 * @constructor
+                 *
+                 * @param elementResiduals The residuals of the single elements. Ownership is taken.
+                 * @param lossFunction The loss function applied per element.
+                 * @param ownership Flag if the ownership of the loss function is taken.
+                 */
+                ElementwiseResidual(const std::vector<ceres::CostFunction *> &elementResiduals,
+                                    ceres::LossFunction *lossFunction,
+                                    ceres::Ownership ownership = ceres::TAKE_OWNERSHIP);
+
+                /**
+                 * @destructor
+                 */
+                ~ElementwiseResidual() override = default;
+
+                /**
+                 * Calculates the residuals of all elements and the diagonal jacobian.
+                 */
+                bool Evaluate(double const *const *parameters, double *residuals, double **jacobians) const override;
+
+                /**
+                 * Factory method to hide the residual creation.
+                 */
+                static ceres::CostFunction *create(const std::vector<ceres::CostFunction *> &elementResiduals,
+                                                   ceres::LossFunction *lossFunction,
+                                                   ceres::Ownership ownership = ceres::TAKE_OWNERSHIP);
+            };
+        }
+    }
+}
+
+#endif //STATICCALIBRATION_ELEMENTWISERESIDUAL_HPP
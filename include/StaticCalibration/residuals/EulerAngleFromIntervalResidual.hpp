@@ -0,0 +1,87 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#ifndef STATICCALIBRATION_EULERANGLEFROMINTERVALRESIDUAL_HPP
+#define STATICCALIBRATION_EULERANGLEFROMINTERVALRESIDUAL_HPP
+
+#include "Eigen/Dense"
+#include "ceres/ceres.h"
+
+namespace static_calibration {
+    namespace calibration {
+        namespace residuals {
+
+            /**
+             * Residual for the distance of one euler angle of the camera pose to a given fixed interval.<br>
+             * The pose holds the rotation in angle axis representation, which is converted to the [x, y, z] euler
+             * angles before the distance is calculated.
+             *
+             * 							|	x - u 	if x > u
+             * Minimizes: f(x, l, u) = 	|	x - l	if x < l
+             * 							|	0 		else
+             */
+            class EulerAngleFromIntervalResidual {
+            protected:
+
+                /**
+                 * The index of the constrained [x, y, z] euler angle.
+                 */
+                int axis;
+
+                /**
+                 * The lower bound if the interval.
+                 */
+                double lowerBound;
+
+                /**
+                 * The upper bound if the interval.
+                 */
+                double upperBound;
+
+            public:
+
+                /**
+                 * @constructor
+                 *
+                 * @param axis The index of the constrained [x, y, z] euler angle.
+                 * @param lowerBound The lower bound of the interval in degrees.
+                 * @param upperBound The upper bound of the interval in degrees.
+                 */
+                EulerAngleFromIntervalResidual(int axis, double lowerBound, double upperBound);
+
+                /**
+                 * @destructor
+                 */
+                virtual ~EulerAngleFromIntervalResidual() = default;
+
+                /**
+                 * Residual calculation function.
+                 *
+                 * @tparam T double or ceres::Jet<double, 6>
+                 *
+                 * @param pose The [tx, ty, tz, ax, ay, az] pose of the camera.
+                 * @param residual The residual, i.e. f(x, l, u)
+                 *
+                 * @return true
+                 */
+                template<typename T>
+                bool operator()(const T *pose, T *residual) const;
+
+                /**
+                 * Factory method to ease residual creation.
+                 *
+                 * @param axis The index of the constrained [x, y, z] euler angle.
+                 * @param lowerBound The lower bound of the interval in degrees.
+                 * @param upperBound The upper bound of the interval in degrees.
+                 *
+                 * @return The cost function based on the residual.
+                 */
+                static ceres::CostFunction *create(int axis, double lowerBound, double upperBound);
+            };
+
+        }
+    }
+}
+
+#endif //STATICCALIBRATION_EULERANGLEFROMINTERVALRESIDUAL_HPP
@@ -0,0 +1,79 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#ifndef STATICCALIBRATION_POSETRANSFORMCACHE_HPP
+#define STATICCALIBRATION_POSETRANSFORMCACHE_HPP
+
+#include "Eigen/Dense"
+#include "ceres/ceres.h"
+#include "StaticCalibration/camera/RenderingPipeline.hpp"
+
+namespace static_calibration {
+    namespace calibration {
+        namespace residuals {
+
+            /**
+             * Calculates the pose dependent camera transform once per evaluation point of the solver.<br>
+             * Attached to the ceres problem as evaluation callback. The correspondence residuals consume the cached
+             * rotation and its derivative instead of recalculating them for every residual block.
+             */
+            class PoseTransformCache : public ceres::EvaluationCallback {
+            protected:
+                /**
+                 * The [tx, ty, tz, ax, ay, az] pose parameter block that is optimized.
+                 */
+                const double *pose;
+
+                /**
+                 * The pose for which the transform was calculated.
+                 */
+                Eigen::Matrix<double, 6, 1> cachedPose;
+
+                /**
+                 * The cached camera transform.
+                 */
+                static_calibration::camera::PoseTransform transform;
+
+                /**
+                 * Flag if the transform was calculated at least once.
+                 */
+                bool valid = false;
+
+                /**
+                 * Flag if the right jacobian of the cached transform was calculated.
+                 */
+                bool hasJacobian = false;
+
+            public:
+                /**
+                 * @constructor
+                 *
+                 * @param pose The [tx, ty, tz, ax, ay, az] pose parameter block that is optimized.
+                 */
+                explicit PoseTransformCache(const double *pose);
+
+                /**
+                 * @destructor
+                 */
+                ~PoseTransformCache() override = default;
+
+                /**
+                 * Recalculates the transform if the solver moved to a new evaluation point.
+                 */
+                void PrepareForEvaluation(bool evaluateJacobians, bool newEvaluationPoint) override;
+
+                /**
+                 * @get The cached transform if it was calculated for the given pose, null otherwise.
+                 *
+                 * @param evaluatedPose The pose of the evaluation.
+                 * @param withJacobian Flag if the evaluation needs the right jacobian of the transform.
+                 */
+                const static_calibration::camera::PoseTransform *getTransform(const double *evaluatedPose,
+                                                                             bool withJacobian) const;
+            };
+        }
+    }
+}
+
+#endif //STATICCALIBRATION_POSETRANSFORMCACHE_HPP
@@ -0,0 +1,34 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#ifndef STATICCALIBRATION_ROBUSTLOSS_HPP
+#define STATICCALIBRATION_ROBUSTLOSS_HPP
+
+#include <vector>
+#include "ceres/ceres.h"
+
+namespace static_calibration {
+    namespace calibration {
+        namespace residuals {
+
+            /**
+             * Applies a loss function to the residuals of one element of an aggregated residual block.<br>
+             * Ceres applies the loss function of a residual block to the squared norm of all its residuals. To keep
+             * one robust loss per element, the residuals r are rescaled to sqrt(rho(s) / s) * r with s = |r|^2, so that
+             * the cost of the aggregated block equals the sum of the losses of its elements.
+             *
+             * @param lossFunction The loss function of the element. Null for the trivial loss.
+             * @param numResiduals The number of residuals of the element.
+             * @param residuals The residuals of the element. Rescaled in place.
+             * @param jacobians The row-major jacobians of the residuals with respect to the parameter blocks.
+             * Corrected in place. Null pointers are skipped.
+             * @param blockSizes The sizes of the parameter blocks, i.e. the columns of the jacobians.
+             */
+            void applyLossFunction(const ceres::LossFunction *lossFunction, int numResiduals, double *residuals,
+                                   double **jacobians, const std::vector<int> &blockSizes);
+        }
+    }
+}
+
+#endif //STATICCALIBRATION_ROBUSTLOSS_HPP
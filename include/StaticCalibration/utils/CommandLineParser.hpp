@@ -8,6 +8,9 @@
 #include "CMakeConfig.h"
 
 #include "Eigen/Dense"
+#include "StaticCalibration/EarlyAbortCallback.hpp"
+#include "StaticCalibration/SolverProfile.hpp"
+#include "StaticCalibration/CameraPoseEstimationBase.hpp"
 #include <boost/algorithm/string/split.hpp>
 #include <boost/foreach.hpp>
 #include <boost/algorithm/string/trim.hpp>
@@ -108,6 +111,68 @@ namespace static_calibration {
              * Flag if to write the rendered frames to disk.
              */
             bool writeVideo;
+
+            /**
+             * Flag if the correspondence residuals use the hand derived jacobians instead of automatic
+             * differentiation.
+             */
+            bool analyticJacobians;
+
+            /**
+             * The number of tries of the estimation that run at once.
+             */
+            int parallelStarts;
+
+            /**
+             * The number of threads shared by all solves, 0 to use all cores.
+             */
+            int maxThreads;
+
+            /**
+             * The master seed of all random number generators, runs with the same seed are reproducible.
+             */
+            std::uint64_t seed;
+
+            /**
+             * The rules that stop hopeless or stalled solves early.
+             */
+            static_calibration::calibration::EarlyAbortOptions earlyAbortOptions;
+
+            /**
+             * The rules of the outlier rejection after the first solve of a try.
+             */
+            static_calibration::calibration::OutlierRejectionOptions outlierRejectionOptions;
+
+            /**
+             * Flag if the covariance of the camera parameters is calculated after the estimation.
+             */
+            bool estimateCovariance;
+
+            /**
+             * The settings of the ceres solver.
+             */
+            static_calibration::calibration::SolverProfile solverProfile;
+
+            /**
+             * Flag if the solver profiles should be auto-tuned on the data set instead of running the calibration.
+             */
+            bool autotune;
+
+            /**
+             * Flag if the candidate mapping extensions start from the solution of the base mapping of the epoch.
+             */
+            bool warmStart;
+
+            /**
+             * The coarse stages that run on subsampled correspondences before the estimation on all correspondences.
+             */
+            std::vector<static_calibration::calibration::CoarseToFineStage> coarseToFineStages;
+
+            /**
+             * Flag if the estimation with the coarse stages should be compared to a single estimation on all
+             * correspondences instead of running the calibration.
+             */
+            bool compareCoarseToFine;
         };
 
         /**
@@ -127,6 +192,27 @@ namespace static_calibration {
          * @return The parsed options wrapped in a usable format.
          */
         ParsedOptions parseCommandLine(int argc, char const *argv[]);
+
+        /**
+         * Writes the solver profile as the solver section of a config file.
+         *
+         * @param filename The path of the written file.
+         * @param solverProfile The written solver profile.
+         */
+        void writeSolverProfile(const std::string &filename,
+                                const static_calibration::calibration::SolverProfile &solverProfile);
+
+        /**
+         * Reads a solver profile written by writeSolverProfile.
+         *
+         * @param filename The path of the read file.
+         * @param solverProfile The profile whose values are overridden by the values in the file.
+         *
+         * @return The read solver profile.
+         */
+        static_calibration::calibration::SolverProfile readSolverProfile(const std::string &filename,
+                                                                         const static_calibration::calibration::SolverProfile &solverProfile =
+                                                                         static_calibration::calibration::SolverProfile());
     }
 }
 
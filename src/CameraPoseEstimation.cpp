@@ -3,34 +3,35 @@
 //
 
 #include "StaticCalibration/CameraPoseEstimation.hpp"
+#include "StaticCalibration/residuals/CorrespondenceGroupResidual.hpp"
 
 namespace static_calibration {
     namespace calibration {
 
         ceres::ResidualBlockId
-        CameraPoseEstimation::addCorrespondenceResidualBlock(ceres::Problem &problem, const ParametricPoint &point,
+        CameraPoseEstimation::addCorrespondenceResidualBlock(ceres::Problem &problem,
+                                                             const std::vector<ParametricPoint> &points,
+                                                             const double *weights,
                                                              ceres::LossFunction *lossFunction) {
             return problem.AddResidualBlock(
-                    residuals::CorrespondenceResidual::create(
-                            point.getExpectedPixel(),
-                            point,
-                            intrinsics
-                    ),
-                    lossFunction,
-                    &translation.x(),
-                    &translation.y(),
-                    &translation.z(),
-                    &rotation.x(),
-                    &rotation.y(),
-                    &rotation.z(),
-                    point.getLambda(),
-                    weights[weights.size() - 1]
+                    residuals::CorrespondenceGroupResidual::create(points, intrinsics, weights, lossFunction,
+                                                                   analyticJacobians, &poseTransformCache),
+                    nullptr,
+                    pose.data(),
+                    points.front().getLambda()
             );
         }
 
         CameraPoseEstimation::CameraPoseEstimation(const std::vector<double> &intrinsics) : CameraPoseEstimationBase(
                 intrinsics) {}
 
+        CameraPoseEstimation::CameraPoseEstimation(const CameraPoseEstimation &other, const objects::DataSet &dataSet)
+                : CameraPoseEstimationBase(other, dataSet) {}
+
+        std::unique_ptr<CameraPoseEstimationBase> CameraPoseEstimation::clone(const objects::DataSet &dataSet) const {
+            return std::unique_ptr<CameraPoseEstimationBase>(new CameraPoseEstimation(*this, dataSet));
+        }
+
         int CameraPoseEstimation::getCorrespondenceLossUpperBound() const {
             return CameraPoseEstimationBase::getCorrespondenceLossUpperBound() * 10;
         }
@@ -5,19 +5,87 @@
 #include "StaticCalibration/CameraPoseEstimationBase.hpp"
 
 #include "ceres/autodiff_cost_function.h"
+#include <chrono>
+#include <cmath>
+#include <exception>
+#include <map>
+#include <algorithm>
 #include <thread>
+#include <atomic>
+#include <mutex>
 #include <StaticCalibration/residuals/CorrespondenceWithIntrinsicsResidual.hpp>
+#include <StaticCalibration/residuals/EulerAngleFromIntervalResidual.hpp>
+#include <StaticCalibration/residuals/ElementwiseResidual.hpp>
+#include "StaticCalibration/camera/RenderingPipeline.hpp"
+#include "StaticCalibration/ThreadBudget.hpp"
 #include <utility>
 
 namespace static_calibration {
     namespace calibration {
 
-        CameraPoseEstimationBase::CameraPoseEstimationBase(const std::vector<double> &intrinsics) {
+        CameraPoseEstimationBase::CameraPoseEstimationBase(const std::vector<double> &intrinsics)
+                : lambdaLossFunction(new ceres::LossFunctionWrapper(nullptr, ceres::TAKE_OWNERSHIP)),
+                  progressCallback(*this),
+                  pose(Eigen::Matrix<double, 6, 1>::Zero()), poseTransformCache(pose.data()) {
             setIntrinsics(intrinsics);
         }
 
-        const Eigen::Vector3d &CameraPoseEstimationBase::getTranslation() const {
-            return translation;
+        CameraPoseEstimationBase::CameraPoseEstimationBase(const CameraPoseEstimationBase &other)
+                : CameraPoseEstimationBase(other, other.dataSet) {}
+
+        CameraPoseEstimationBase::CameraPoseEstimationBase(const CameraPoseEstimationBase &other,
+                                                           const objects::DataSet &_dataSet)
+                : lambdaLossFunction(new ceres::LossFunctionWrapper(nullptr, ceres::TAKE_OWNERSHIP)),
+                  initialTranslation(other.initialTranslation),
+                  initialRotation(other.initialRotation),
+                  dataSet(_dataSet),
+                  warmStart(other.warmStart),
+                  hasRotationGuess(other.hasRotationGuess),
+                  hasTranslationGuess(other.hasTranslationGuess),
+                  lambdaResidualScalingFactor(other.lambdaResidualScalingFactor),
+                  rotationResidualScalingFactor(other.rotationResidualScalingFactor),
+                  initialDistanceFromMean(other.initialDistanceFromMean),
+                  maxTriesUntilAbort(other.maxTriesUntilAbort),
+                  numParallelStarts(other.numParallelStarts),
+                  seed(other.seed),
+                  solverProfile(other.solverProfile),
+                  earlyAbortOptions(other.earlyAbortOptions),
+                  coarseToFineStages(other.coarseToFineStages),
+                  outlierRejectionOptions(other.outlierRejectionOptions),
+                  covarianceEnabled(other.covarianceEnabled),
+                  progressCallback(*this),
+                  pose(other.pose),
+                  poseTransformCache(pose.data()),
+                  maxPointsPerResidualBlock(other.maxPointsPerResidualBlock),
+                  intrinsics(other.intrinsics),
+                  initialIntrinsics(other.initialIntrinsics),
+                  analyticJacobians(other.analyticJacobians) {
+            dataSet.detachLambdas();
+        }
+
+        std::unique_ptr<CameraPoseEstimationBase>
+        CameraPoseEstimationBase::clone(const objects::DataSet &dataSet) const {
+            return std::unique_ptr<CameraPoseEstimationBase>(new CameraPoseEstimationBase(*this, dataSet));
+        }
+
+        std::unique_ptr<CameraPoseEstimationBase> CameraPoseEstimationBase::clone() const {
+            return clone(dataSet);
+        }
+
+        const Eigen::Matrix<double, 6, 1> &CameraPoseEstimationBase::getPose() const {
+            return pose;
+        }
+
+        Eigen::Vector3d CameraPoseEstimationBase::getTranslation() const {
+            return pose.head<3>();
+        }
+
+        void CameraPoseEstimationBase::setTranslation(const Eigen::Vector3d &translation) {
+            pose.head<3>() = translation;
+        }
+
+        void CameraPoseEstimationBase::setRotation(const Eigen::Vector3d &rotation) {
+            pose.tail<3>() = static_calibration::camera::getAngleAxisFromEulerAngles(rotation.data());
         }
 
         Eigen::Vector3d CameraPoseEstimationBase::clearRotation(const Eigen::Vector3d &rotation) {
@@ -36,7 +104,7 @@ namespace static_calibration {
         }
 
         Eigen::Vector3d CameraPoseEstimationBase::getRotation() const {
-            return clearRotation(rotation);
+            return clearRotation(static_calibration::camera::getEulerAnglesFromAngleAxis(pose.data() + 3));
         }
 
         void CameraPoseEstimationBase::calculateInitialGuess() {
@@ -45,15 +113,15 @@ namespace static_calibration {
 
                 initialTranslation = mean;
                 initialTranslation.z() += initialDistanceFromMean;
-                translation = initialTranslation;
+                setTranslation(initialTranslation);
             }
 
             if (!hasRotationGuess) {
                 double x = 35.;
-                initialRotation = {generateRandomNumber(-x, x),
-                                   generateRandomNumber(-x, x),
-                                   generateRandomNumber(-x, x)};
-                rotation = initialRotation;
+                initialRotation = {generateRandomNumber(randomEngine, -x, x),
+                                   generateRandomNumber(randomEngine, -x, x),
+                                   generateRandomNumber(randomEngine, -x, x)};
+                setRotation(initialRotation);
             }
         }
 
@@ -66,23 +134,125 @@ namespace static_calibration {
             return meanVector / parametricPoints.size();
         }
 
-        std::thread CameraPoseEstimationBase::estimateAsync(bool logSummary) {
-            auto thread = std::thread(&CameraPoseEstimationBase::estimate, this, logSummary);
-            thread.detach();
-            return thread;
+        std::future<void> CameraPoseEstimationBase::estimateAsync(bool logSummary) {
+            // Reset the state before returning so that the caller never observes the previous estimation.
+            startEstimation();
+            return std::async(std::launch::async, &CameraPoseEstimationBase::runEstimation, this, logSummary);
+        }
+
+        void CameraPoseEstimationBase::cancel() {
+            cancelRequested = true;
+        }
+
+        bool CameraPoseEstimationBase::isCancelled() const {
+            return cancelRequested || isSuperseded() || (parent != nullptr && parent->isCancelled());
+        }
+
+        bool CameraPoseEstimationBase::isSuperseded() const {
+            return firstValidTry != nullptr && *firstValidTry < currentTry;
+        }
+
+        EstimationSnapshot CameraPoseEstimationBase::getSnapshot() const {
+            std::lock_guard<std::mutex> lock(snapshotMutex);
+            return snapshot;
+        }
+
+        CameraPoseEstimationBase &CameraPoseEstimationBase::getRoot() {
+            return progressReceiver != nullptr ? progressReceiver->getRoot() : *this;
         }
 
-        ceres::Problem CameraPoseEstimationBase::solveProblem(bool logSummary) {
-            auto problem = createProblem();
+        void CameraPoseEstimationBase::publishSnapshot(int iteration, double cost) {
+            auto &root = getRoot();
+            std::lock_guard<std::mutex> lock(root.snapshotMutex);
+            root.snapshot.translation = getTranslation();
+            root.snapshot.rotation = getRotation();
+            root.snapshot.intrinsics = intrinsics;
+            root.snapshot.iterations = iteration;
+            root.snapshot.cost = cost;
+        }
+
+        void CameraPoseEstimationBase::startEstimation() {
+            cancelRequested = false;
+            bestCost = std::numeric_limits<double>::infinity();
+            optimizationFinished = false;
+            {
+                std::lock_guard<std::mutex> lock(snapshotMutex);
+                snapshot = EstimationSnapshot();
+            }
+            publishSnapshot(0, 0);
+        }
+
+        CameraPoseEstimationBase::ProgressCallback::ProgressCallback(CameraPoseEstimationBase &estimator)
+                : estimator(estimator) {}
+
+        ceres::CallbackReturnType
+        CameraPoseEstimationBase::ProgressCallback::operator()(const ceres::IterationSummary &summary) {
+            // The parameters are up to date as the solver updates the state every iteration.
+            estimator.publishSnapshot(summary.iteration, summary.cost);
+            return estimator.isCancelled() ? ceres::SOLVER_ABORT : ceres::SOLVER_CONTINUE;
+        }
+
+        void CameraPoseEstimationBase::solveProblem(bool logSummary) {
+            if (problem == nullptr) {
+                createProblem();
+            }
+            updateLossFunctions();
+
             auto options = setupOptions(logSummary);
-            Solve(options, &problem, &summary);
-            evaluateAllResiduals(problem);
-            evaluateCorrespondenceResiduals(problem);
-            evaluateExplicitRoadMarkResiduals(problem);
-            evaluateLambdaResiduals(problem);
-            evaluateRotationResiduals(problem);
-            evaluateWeightResiduals(problem);
-            return problem;
+            // Lease the threads only for the solve itself, so that concurrent solves share the cores.
+            auto lease = ThreadBudget::getInstance().acquire(
+                    solverProfile.getRequestedThreads(problem->NumResidualBlocks()));
+            options.num_threads = lease.getThreads();
+            EarlyAbortCallback earlyAbortCallback(earlyAbortOptions, bestCost);
+            if (!refining) {
+                options.callbacks.emplace_back(&earlyAbortCallback);
+            }
+            Solve(options, problem.get(), &summary);
+            abortedEarly = earlyAbortCallback.hasAborted();
+
+            // The residual blocks are evaluated outside of the solver, hence update the cached camera transform.
+            poseTransformCache.PrepareForEvaluation(false, true);
+            evaluateResiduals(*problem);
+        }
+
+        void CameraPoseEstimationBase::applyWarmStart() {
+            pose = warmStart->pose;
+            initialTranslation = getTranslation();
+            initialRotation = getRotation();
+            if (warmStart->intrinsics.size() == intrinsics.size()) {
+                copyIntrinsicsInPlace(warmStart->intrinsics);
+            }
+
+            for (const auto &point: dataSet.getParametricPoints<Object>()) {
+                *point.getLambda() = calculateClosestLambda(point);
+            }
+            for (const auto &point: dataSet.getParametricPoints<RoadMark>()) {
+                *point.getLambda() = calculateClosestLambda(point);
+            }
+            dataSet.setLambdas(warmStart->lambdas);
+        }
+
+        double CameraPoseEstimationBase::calculateClosestLambda(const ParametricPoint &point) const {
+            // The viewing ray of the pixel in world space, i.e. the inverse of the rendering in renderPose.
+            const Eigen::Vector3d cameraDirection{
+                    (point.getExpectedPixel().x() - intrinsics[2]) / intrinsics[0],
+                    (point.getExpectedPixel().y() - intrinsics[3]) / intrinsics[1],
+                    1
+            };
+            const Eigen::Vector3d rayDirection =
+                    static_calibration::camera::getCameraRotationFromAngleAxis(pose.data() + 3) * cameraDirection;
+
+            // The closest points of the lines origin + lambda * axis and translation + s * rayDirection.
+            const Eigen::Vector3d &axis = point.getAxisA();
+            const Eigen::Vector3d offset = point.getOrigin() - getTranslation();
+            const double axisRay = axis.dot(rayDirection);
+            const double rayRay = rayDirection.dot(rayDirection);
+            const double denominator = axis.dot(axis) * rayRay - axisRay * axisRay;
+            double lambda = 0;
+            if (std::abs(denominator) > 1e-12) {
+                lambda = (axisRay * rayDirection.dot(offset) - rayRay * axis.dot(offset)) / denominator;
+            }
+            return std::max(point.getLambdaMin(), std::min(point.getLambdaMax(), lambda));
         }
 
         std::vector<double> CameraPoseEstimationBase::getLambdas() {
@@ -101,66 +271,327 @@ namespace static_calibration {
         }
 
         void CameraPoseEstimationBase::estimate(bool logSummary) {
-            optimizationFinished = false;
+            startEstimation();
+            runEstimation(logSummary);
+        }
+
+        void CameraPoseEstimationBase::runEstimation(bool logSummary) {
             foundValidSolution = false;
-            int i = 0;
-            for (; i < maxTriesUntilAbort; i++) {
-                resetParameters();
+            poseCovariance = PoseCovariance();
+            const auto originalWarmStart = warmStart;
+            if (!coarseToFineStages.empty()) {
+                warmStart = estimateCoarseStages();
+            }
+            if (numParallelStarts > 1) {
+                foundValidSolution = estimateParallel();
+            } else {
+                for (int i = 0; i < maxTriesUntilAbort && !isCancelled(); i++) {
+                    if (runTry(logSummary, i, i == 0 && warmStart != nullptr)) {
+                        foundValidSolution = true;
+                        break;
+                    }
+                }
+            }
+            warmStart = originalWarmStart;
+            publishSnapshot((int) summary.iterations.size(), summary.final_cost);
+            if (logSummary) {
+                std::cout << *this << std::endl;
+            }
+            // The caller may modify the estimator as soon as it observes the flag, hence it is the last access.
+            optimizationFinished = true;
+        }
+
+        bool CameraPoseEstimationBase::runTry(bool logSummary, int tryIndex, bool warmStarted) {
+            {
+                auto &root = getRoot();
+                std::lock_guard<std::mutex> lock(root.snapshotMutex);
+                root.snapshot.tries++;
+            }
+            currentTry = tryIndex;
+            resetParameters();
+            if (warmStarted) {
+                applyWarmStart();
+            } else {
+                // The guess only depends on the index of the try, not on the worker that runs it.
+                randomEngine.seed(deriveSeed(seed, tryIndex));
                 calculateInitialGuess();
-                solveProblem(logSummary);
+            }
+            solveProblem(logSummary);
+            if (isCancelled() || abortedEarly) {
+                return false;
+            }
+
+            bool invalidSolution = false;
+            bool invalidLosses = rotationsLoss > 1e-6 || intrinsicsLoss > 5;
+            bool invalidCorrespondencesLoss = correspondencesLoss > getCorrespondenceLossUpperBound();
+//            invalidSolution = invalidSolution || invalidCorrespondencesLoss;
+//            bool invalidLambdas = lambdasLoss > 10;
+            double rotationDiff = (initialRotation - getRotation()).norm();
+//            std::cout << rotationDiff << std::endl;
+            bool invalidRotation = rotationDiff > 50;
+            double translationDiff = (initialTranslation - getTranslation()).norm();
+//            std::cout << translationDiff << std::endl;
+            bool invalidTranslation = translationDiff > 100;
+
+//            invalidSolution = invalidSolution || invalidLambdas;
+//            invalidSolution = invalidSolution || invalidCorrespondencesLoss;
+//            invalidSolution = invalidSolution || invalidLosses;
+//            invalidSolution = invalidSolution || invalidTranslation;
+//            invalidSolution = invalidSolution || invalidRotation;
+
+            if (invalidSolution) {
+                return false;
+            }
+            if (firstValidTry != nullptr) {
+                // Stops the parallel tries with a higher index, as the valid try with the lowest index is used.
+                int expected = *firstValidTry;
+                while (tryIndex < expected && !firstValidTry->compare_exchange_weak(expected, tryIndex)) {}
+            }
+            rejectOutliers(logSummary);
+            if (isCancelled()) {
+                return false;
+            }
+            double originalPenalize = lambdaResidualScalingFactor;
+            lambdaResidualScalingFactor = originalPenalize * 10;
+            refining = true;
+            solveProblem(logSummary);
+            refining = false;
+            lambdaResidualScalingFactor = originalPenalize;
+            if (covarianceEnabled && !isCancelled()) {
+                calculateCovariance();
+            }
+            return true;
+        }
+
+        bool CameraPoseEstimationBase::estimateParallel() {
+            // Many narrow solves instead of one wide solve, each try gets its share of the budget.
+            int threadsPerTry = ThreadBudget::getInstance().getThreadsPerJob(numParallelStarts);
+            if (solverProfile.numThreads > 0) {
+                threadsPerTry = std::min(threadsPerTry, solverProfile.numThreads);
+            }
+
+            std::atomic<int> firstValid{std::numeric_limits<int>::max()};
+            std::vector<std::unique_ptr<CameraPoseEstimationBase>> workers;
+            for (int i = 0; i < numParallelStarts; i++) {
+                workers.emplace_back(clone());
+                workers.back()->solverProfile.numThreads = threadsPerTry;
+                workers.back()->parent = this;
+                workers.back()->progressReceiver = this;
+                workers.back()->firstValidTry = &firstValid;
+            }
+
+            const CameraPoseEstimationBase *bestWorker = nullptr;
+            // The tries run in fixed rounds, hence the started tries do not depend on the timing of the threads.
+            for (int round = 0; round < maxTriesUntilAbort && bestWorker == nullptr && !isCancelled();
+                 round += numParallelStarts) {
+                int numTries = std::min(numParallelStarts, maxTriesUntilAbort - round);
+                std::vector<char> valid(numTries, false);
+                std::vector<std::thread> threads;
+                for (int i = 0; i < numTries; i++) {
+                    // The tries of a round only see the best cost of the earlier rounds and their own costs.
+                    workers[i]->bestCost = bestCost.load();
+                    threads.emplace_back([&, i, worker = workers[i].get()]() {
+                        int tryIndex = round + i;
+                        valid[i] = worker->runTry(false, tryIndex, tryIndex == 0 && warmStart != nullptr);
+                        if (!valid[i] && worker->isSuperseded() && !worker->abortedEarly &&
+                            worker->summary.termination_type == ceres::USER_FAILURE) {
+                            auto &root = getRoot();
+                            std::lock_guard<std::mutex> lock(root.snapshotMutex);
+                            root.snapshot.stoppedTries++;
+                        }
+                    });
+                }
+                for (auto &thread: threads) {
+                    thread.join();
+                }
+
+                for (int i = 0; i < numTries; i++) {
+                    bestCost = std::min(bestCost.load(), workers[i]->bestCost.load());
+                }
+                // The valid try with the lowest index wins, as in the sequential estimation.
+                for (int i = 0; i < numTries && bestWorker == nullptr; i++) {
+                    if (valid[i]) {
+                        bestWorker = workers[i].get();
+                    }
+                }
+            }
+
+            if (bestWorker == nullptr) {
+                return false;
+            }
+            adoptSolution(*bestWorker);
+            return true;
+        }
+
+        std::shared_ptr<const WarmStart> CameraPoseEstimationBase::estimateCoarseStages() {
+            auto start = warmStart;
+            for (const auto &stage: coarseToFineStages) {
+                auto coarse = clone(dataSet.subsample(stage.rowStride, stage.maxPointsPerEntry));
+                coarse->parent = this;
+                coarse->progressReceiver = this;
+                coarse->coarseToFineStages.clear();
+                coarse->covarianceEnabled = false;
+                coarse->warmStart = start;
+                coarse->runEstimation(false);
+
+                if (isCancelled() || !coarse->foundValidSolution) {
+                    break;
+                }
+                // The lambdas of the entries whose number of points differs in the next stage are initialized to the
+                // closest points.
+                start = std::make_shared<const WarmStart>(coarse->getWarmStart());
+            }
+            return start;
+        }
+
+        void CameraPoseEstimationBase::calculateCovariance() {
+            auto start = std::chrono::steady_clock::now();
+            poseCovariance = PoseCovariance();
+            // The residual blocks are evaluated outside of the solver, hence provide the derivative of the transform.
+            poseTransformCache.PrepareForEvaluation(true, false);
 
-                bool invalidSolution = false;
-                bool invalidLosses = rotationsLoss > 1e-6 || intrinsicsLoss > 5;
-                bool invalidCorrespondencesLoss = correspondencesLoss > getCorrespondenceLossUpperBound();
-//                invalidSolution = invalidSolution || invalidCorrespondencesLoss;
-//                bool invalidLambdas = lambdasLoss > 10;
-                double rotationDiff = (initialRotation - rotation).norm();
-//                std::cout << rotationDiff << std::endl;
-                bool invalidRotation = rotationDiff > 50;
-                double translationDiff = (initialTranslation - translation).norm();
-//                std::cout << translationDiff << std::endl;
-                bool invalidTranslation = translationDiff > 100;
-
-//                invalidSolution = invalidSolution || invalidLambdas;
-//                invalidSolution = invalidSolution || invalidCorrespondencesLoss;
-//                invalidSolution = invalidSolution || invalidLosses;
-//                invalidSolution = invalidSolution || invalidTranslation;
-//                invalidSolution = invalidSolution || invalidRotation;
-
-                if (invalidSolution) {
+            std::vector<double *> cameraBlocks{pose.data()};
+            if (problem->HasParameterBlock(intrinsics.data()) && !problem->IsParameterBlockConstant(intrinsics.data())) {
+                cameraBlocks.emplace_back(intrinsics.data());
+            }
+            std::vector<int> cameraOffsets;
+            int numCameraParameters = 0;
+            for (const auto &block: cameraBlocks) {
+                cameraOffsets.emplace_back(numCameraParameters);
+                numCameraParameters += problem->ParameterBlockLocalSize(block);
+            }
+
+            // The normal equations of the camera parameters, of the eliminated blocks and their coupling.
+            typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Jacobian;
+            Eigen::MatrixXd cameraInformation = Eigen::MatrixXd::Zero(numCameraParameters, numCameraParameters);
+            std::map<const double *, std::pair<Eigen::MatrixXd, Eigen::MatrixXd>> eliminatedBlocks;
+
+            std::vector<ceres::ResidualBlockId> residualBlocks;
+            problem->GetResidualBlocks(&residualBlocks);
+            std::vector<double *> parameterBlocks;
+            std::vector<Jacobian> jacobians;
+            std::vector<double *> jacobianPointers;
+            std::vector<double> residuals;
+            for (const auto &residualBlock: residualBlocks) {
+                problem->GetParameterBlocksForResidualBlock(residualBlock, &parameterBlocks);
+                int numResiduals = problem->GetCostFunctionForResidualBlock(residualBlock)->num_residuals();
+                jacobians.resize(parameterBlocks.size());
+                jacobianPointers.assign(parameterBlocks.size(), nullptr);
+                for (int i = 0; i < parameterBlocks.size(); i++) {
+                    if (!problem->IsParameterBlockConstant(parameterBlocks[i])) {
+                        jacobians[i].resize(numResiduals, problem->ParameterBlockLocalSize(parameterBlocks[i]));
+                        jacobianPointers[i] = jacobians[i].data();
+                    }
+                }
+                residuals.resize(numResiduals);
+                double cost;
+                if (!problem->EvaluateResidualBlock(residualBlock, true, &cost, residuals.data(),
+                                                    jacobianPointers.data())) {
+                    return;
+                }
+
+                Eigen::MatrixXd cameraJacobian = Eigen::MatrixXd::Zero(numResiduals, numCameraParameters);
+                int eliminatedIndex = -1;
+                for (int i = 0; i < parameterBlocks.size(); i++) {
+                    if (jacobianPointers[i] == nullptr) {
+                        continue;
+                    }
+                    auto cameraBlock = std::find(cameraBlocks.begin(), cameraBlocks.end(), parameterBlocks[i]);
+                    if (cameraBlock != cameraBlocks.end()) {
+                        cameraJacobian.middleCols(cameraOffsets[cameraBlock - cameraBlocks.begin()],
+                                                  jacobians[i].cols()) = jacobians[i];
+                    } else {
+                        eliminatedIndex = i;
+                    }
+                }
+                cameraInformation += cameraJacobian.transpose() * cameraJacobian;
+                if (eliminatedIndex < 0) {
                     continue;
                 }
-                double originalPenalize = lambdaResidualScalingFactor;
-                lambdaResidualScalingFactor = originalPenalize * 10;
-                solveProblem(logSummary);
-                lambdaResidualScalingFactor = originalPenalize;
-                break;
+
+                const Jacobian &eliminatedJacobian = jacobians[eliminatedIndex];
+                auto &eliminatedBlock = eliminatedBlocks[parameterBlocks[eliminatedIndex]];
+                if (eliminatedBlock.first.size() == 0) {
+                    eliminatedBlock.first = Eigen::MatrixXd::Zero(eliminatedJacobian.cols(), eliminatedJacobian.cols());
+                    eliminatedBlock.second = Eigen::MatrixXd::Zero(numCameraParameters, eliminatedJacobian.cols());
+                }
+                eliminatedBlock.first += eliminatedJacobian.transpose() * eliminatedJacobian;
+                eliminatedBlock.second += cameraJacobian.transpose() * eliminatedJacobian;
             }
 
-            foundValidSolution = i < maxTriesUntilAbort;
-            optimizationFinished = true;
-            if (logSummary) {
-                std::cout << *this << std::endl;
+            // Lambdas without observations, e.g. of rejected correspondences, do not couple to the camera parameters,
+            // hence the pseudo inverse of their singular blocks is exact.
+            for (const auto &entry: eliminatedBlocks) {
+                const auto &coupling = entry.second.second;
+                cameraInformation -= coupling * entry.second.first.completeOrthogonalDecomposition().solve(
+                        Eigen::MatrixXd(coupling.transpose()));
+            }
+
+            Eigen::SelfAdjointEigenSolver<Eigen::MatrixXd> eigenSolver(cameraInformation);
+            const Eigen::VectorXd &eigenvalues = eigenSolver.eigenvalues();
+            if (eigenSolver.info() != Eigen::Success || eigenvalues.maxCoeff() <= 0 ||
+                eigenvalues.minCoeff() <= 1e-14 * eigenvalues.maxCoeff()) {
+                return;
+            }
+            Eigen::MatrixXd covariance = eigenSolver.eigenvectors() * eigenvalues.cwiseInverse().asDiagonal() *
+                                         eigenSolver.eigenvectors().transpose();
+
+            poseCovariance.pose = covariance.topLeftCorner<6, 6>();
+            if (numCameraParameters > 6) {
+                poseCovariance.intrinsics = covariance.block<4, 4>(6, 6);
+            }
+            poseCovariance.valid = true;
+            std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+            poseCovariance.seconds = duration.count();
+        }
+
+        void CameraPoseEstimationBase::adoptSolution(const CameraPoseEstimationBase &other) {
+            pose = other.pose;
+            initialTranslation = other.initialTranslation;
+            initialRotation = other.initialRotation;
+            std::copy(other.intrinsics.begin(), other.intrinsics.end(), intrinsics.begin());
+
+            // The correspondence residual blocks reference the weight buffers that are replaced.
+            weights = other.weights;
+            resetProblem();
+            for (int i = 0; i < dataSet.getParametricPoints<Object>().size(); i++) {
+                *dataSet.getParametricPoints<Object>()[i].getLambda() =
+                        *other.dataSet.getParametricPoints<Object>()[i].getLambda();
+            }
+            for (int i = 0; i < dataSet.getParametricPoints<RoadMark>().size(); i++) {
+                *dataSet.getParametricPoints<RoadMark>()[i].getLambda() =
+                        *other.dataSet.getParametricPoints<RoadMark>()[i].getLambda();
             }
 
+            summary = other.summary;
+            lambdasLoss = other.lambdasLoss;
+            correspondencesLoss = other.correspondencesLoss;
+            explicitRoadMarksLoss = other.explicitRoadMarksLoss;
+            rotationsLoss = other.rotationsLoss;
+            totalLoss = other.totalLoss;
+            intrinsicsLoss = other.intrinsicsLoss;
+            residualEvaluation = other.residualEvaluation;
+            poseCovariance = other.poseCovariance;
         }
 
         ceres::Solver::Options CameraPoseEstimationBase::setupOptions(bool logSummary) {
             ceres::Solver::Options options;
-            options.linear_solver_type = ceres::SPARSE_NORMAL_CHOLESKY;
-//			options.trust_region_strategy_type = ceres::DOGLEG;
-//			options.use_nonmonotonic_steps = true;
+            solverProfile.apply(options);
+            if (solverProfile.usesSchurComplement()) {
+                // Copy the ordering, as the solver may modify it. The camera parameters are eliminated last.
+                options.linear_solver_ordering = std::make_shared<ceres::ParameterBlockOrdering>(
+                        *linearSolverOrdering);
+                options.linear_solver_ordering->AddElementToGroup(pose.data(), 1);
+                if (problem->HasParameterBlock(intrinsics.data())) {
+                    options.linear_solver_ordering->AddElementToGroup(intrinsics.data(), 1);
+                }
+                options.preconditioner_type = ceres::SCHUR_JACOBI;
+            }
 //			options.max_num_consecutive_invalid_steps = 15;
 //			options.max_num_iterations = weights.size();
-            options.max_num_iterations = 400;
-            auto processorCount = std::thread::hardware_concurrency();
-            if (processorCount == 0) {
-                processorCount = 8;
-            }
-            options.num_threads = (int) processorCount;
-//            options.num_threads = 1;
             options.minimizer_progress_to_stdout = logSummary;
             options.update_state_every_iteration = true;
+            options.callbacks.emplace_back(&progressCallback);
             if (!logSummary) {
                 options.logging_type = ceres::SILENT;
             }
@@ -186,73 +617,224 @@ namespace static_calibration {
             for (const auto &point: dataSet.getParametricPoints<RoadMark>()) {
                 *point.getLambda() = 0;
             }
+            resetWeights();
         }
 
-        // TODO do not recreate; Create only once by dedicated call and reset values in residual blocks.
-        // TODO This should remove the memory leak!!!
-        ceres::Problem CameraPoseEstimationBase::createProblem() {
-            auto problem = ceres::Problem();
-            for (auto p: weights) {
-                delete p;
+        void CameraPoseEstimationBase::resetWeights() {
+            for (auto &blockWeights: weights) {
+                std::fill(blockWeights.begin(), blockWeights.end(), 1.);
             }
+        }
+
+        double CameraPoseEstimationBase::calculatePixelError(const ParametricPoint &point) const {
+            const Eigen::Vector3d position = point.getPosition();
+            bool flipped;
+            const Eigen::Vector2d pixel = camera::renderPose(pose.data(), intrinsics.data(), position.data(),
+                                                             flipped);
+            if (flipped) {
+                return std::numeric_limits<double>::infinity();
+            }
+            return (point.getExpectedPixel() - pixel).norm();
+        }
+
+        void CameraPoseEstimationBase::collectPointErrors(
+                const std::vector<ParametricPoint> &points, const std::vector<std::pair<int, int>> &groups,
+                std::vector<std::pair<double *, double>> &pointErrors) const {
+            for (const auto &group: groups) {
+                for (int begin = group.first; begin < group.second; begin += maxPointsPerResidualBlock) {
+                    auto residualBlockGroup = residualBlockGroups.find(points[begin].getLambda());
+                    if (residualBlockGroup == residualBlockGroups.end()) {
+                        continue;
+                    }
+                    int end = std::min(begin + maxPointsPerResidualBlock, group.second);
+                    for (int i = begin; i < end; i++) {
+                        pointErrors.emplace_back(residualBlockGroup->second.weights + (i - begin),
+                                                 calculatePixelError(points[i]));
+                    }
+                }
+            }
+        }
+
+        bool CameraPoseEstimationBase::updateOutlierWeights() {
+            std::vector<std::pair<double *, double>> pointErrors;
+            collectPointErrors(dataSet.getParametricPoints<Object>(), dataSet.getParametricPointGroups<Object>(),
+                               pointErrors);
+            collectPointErrors(dataSet.getParametricPoints<RoadMark>(), dataSet.getParametricPointGroups<RoadMark>(),
+                               pointErrors);
+            if (pointErrors.empty()) {
+                return false;
+            }
+
+            std::vector<double> errors;
+            errors.reserve(pointErrors.size());
+            for (const auto &pointError: pointErrors) {
+                errors.emplace_back(pointError.second);
+            }
+            auto median = errors.begin() + errors.size() / 2;
+            std::nth_element(errors.begin(), median, errors.end());
+            double threshold = std::max(outlierRejectionOptions.minThreshold,
+                                        outlierRejectionOptions.thresholdScale * *median);
+            // Never reject more than the maximal outlier ratio, i.e. keep at least the best correspondences.
+            int minInliers = (int) std::ceil((1 - outlierRejectionOptions.maxOutlierRatio) * (double) errors.size());
+            auto lastInlier = errors.begin() + std::max(0, std::min((int) errors.size(), minInliers) - 1);
+            std::nth_element(errors.begin(), lastInlier, errors.end());
+            threshold = std::max(threshold, *lastInlier);
+
+            bool changed = false;
+            std::vector<double> newWeights;
+            newWeights.reserve(pointErrors.size());
+            for (const auto &pointError: pointErrors) {
+                double weight = 1;
+                if (pointError.second > threshold) {
+                    weight = outlierRejectionOptions.reweight ? threshold / pointError.second : 0;
+                }
+                changed |= (weight < 1) != (*pointError.first < 1);
+                newWeights.emplace_back(weight);
+            }
+            if (!changed) {
+                return false;
+            }
+            for (int i = 0; i < pointErrors.size(); i++) {
+                *pointErrors[i].first = newWeights[i];
+            }
+            return true;
+        }
+
+        void CameraPoseEstimationBase::rejectOutliers(bool logSummary) {
+            for (int round = 0; round < outlierRejectionOptions.maxRounds && !isCancelled(); round++) {
+                if (!updateOutlierWeights()) {
+                    break;
+                }
+                // Re-solve from the current state, hence never abort early compared to the full first solves.
+                bool originalRefining = refining;
+                refining = true;
+                solveProblem(logSummary);
+                refining = originalRefining;
+            }
+        }
+
+        void CameraPoseEstimationBase::updateLossFunctions() {
+            lambdaLossFunction->Reset(getScaledHuberLoss(lambdaResidualScalingFactor), ceres::TAKE_OWNERSHIP);
+        }
+
+        void CameraPoseEstimationBase::resetProblem() {
+            problem.reset();
+        }
+
+        void CameraPoseEstimationBase::copyIntrinsicsInPlace(const std::vector<double> &values) {
+            std::copy(values.begin(), values.end(), intrinsics.begin());
+        }
+
+        void CameraPoseEstimationBase::createProblem() {
+            ceres::Problem::Options problemOptions;
+            problemOptions.evaluation_callback = &poseTransformCache;
+            // Removing the residual blocks of a mapping extension would scan all residual blocks otherwise.
+            problemOptions.enable_fast_removal = true;
+            // All problems share the thread pool of one context instead of creating their own.
+            problemOptions.context = ThreadBudget::getInstance().getContext();
+            problem = std::make_unique<ceres::Problem>(problemOptions);
+            linearSolverOrdering = std::make_shared<ceres::ParameterBlockOrdering>();
+            residualBlockGroups.clear();
             weights.clear();
             correspondenceResiduals.clear();
             explicitRoadMarkResiduals.clear();
-            weightResiduals.clear();
             lambdaResiduals.clear();
 
-            for (const auto &point: dataSet.getParametricPoints<Object>()) {
-                weights.emplace_back(new double(1));
-                correspondenceResiduals.emplace_back(
-                        addCorrespondenceResidualBlock(problem, point, new ceres::HuberLoss(1.0)));
-                lambdaResiduals.emplace_back(addLambdaResidualBlock(problem, point));
-                weightResiduals.emplace_back(addWeightResidualBlock(problem, weights[weights.size() - 1]));
-            }
+            addResidualBlocks(*problem, dataSet.getParametricPoints<Object>(),
+                              dataSet.getParametricPointGroups<Object>(), correspondenceResiduals, 1.0);
+            addResidualBlocks(*problem, dataSet.getParametricPoints<RoadMark>(),
+                              dataSet.getParametricPointGroups<RoadMark>(), explicitRoadMarkResiduals,
+                              (double) dataSet.getMapping().size());
 
-            for (const auto &point: dataSet.getParametricPoints<RoadMark>()) {
-                weights.emplace_back(new double(1));
-                explicitRoadMarkResiduals.emplace_back(
-                        addCorrespondenceResidualBlock(problem, point,
-                                                       new ceres::HuberLoss(dataSet.getMapping().size())));
-                lambdaResiduals.emplace_back(addLambdaResidualBlock(problem, point));
-                weightResiduals.emplace_back(addWeightResidualBlock(problem, weights[weights.size() - 1]));
-            }
+            addRotationConstraints(*problem);
+        }
 
-            addRotationConstraints(problem);
+        void CameraPoseEstimationBase::addResidualBlocks(ceres::Problem &problem,
+                                                         const std::vector<ParametricPoint> &points,
+                                                         const std::vector<std::pair<int, int>> &groups,
+                                                         std::vector<ceres::ResidualBlockId> &correspondenceResidualIds,
+                                                         double huberLoss) {
+            for (const auto &group: groups) {
+                for (int begin = group.first; begin < group.second; begin += maxPointsPerResidualBlock) {
+                    if (residualBlockGroups.count(points[begin].getLambda()) > 0) {
+                        // Already in the problem from before the last mapping extension.
+                        continue;
+                    }
+                    int end = std::min(begin + maxPointsPerResidualBlock, group.second);
+                    std::vector<ParametricPoint> blockPoints(points.begin() + begin, points.begin() + end);
+                    weights.emplace_back(blockPoints.size(), 1.);
+                    double *blockWeights = weights.back().data();
+
+                    ResidualBlockGroup residualBlockGroup;
+                    residualBlockGroup.weights = blockWeights;
+                    residualBlockGroup.correspondence = addCorrespondenceResidualBlock(
+                            problem, blockPoints, blockWeights, new ceres::HuberLoss(huberLoss));
+                    residualBlockGroup.lambda = addLambdaResidualBlock(problem, blockPoints);
+                    correspondenceResidualIds.emplace_back(residualBlockGroup.correspondence);
+                    lambdaResiduals.emplace_back(residualBlockGroup.lambda);
+                    residualBlockGroups[blockPoints.front().getLambda()] = residualBlockGroup;
+
+                    // The lambdas of different blocks never share a residual block, hence they form an independent
+                    // set for the first elimination group.
+                    linearSolverOrdering->AddElementToGroup(blockPoints.front().getLambda(), 0);
+                }
+            }
+        }
 
-//			std::cout << "Residuals: " << problem.NumResidualBlocks() << std::endl;
-            return problem;
+        /**
+         * Removes the given id from the list of ids.
+         */
+        static void removeResidualBlockId(std::vector<ceres::ResidualBlockId> &ids, ceres::ResidualBlockId id) {
+            ids.erase(std::remove(ids.begin(), ids.end(), id), ids.end());
         }
 
-        ceres::ResidualBlockId
-        CameraPoseEstimationBase::addWeightResidualBlock(ceres::Problem &problem, double *weight) const {
-            return problem.AddResidualBlock(
-                    residuals::DistanceResidual::create(1),
-                    getScaledHuberLoss(weightResidualScalingFactor),
-                    weight
-            );
+        void CameraPoseEstimationBase::removeResidualBlockGroup(const double *lambda) {
+            auto group = residualBlockGroups.find(lambda);
+            if (group == residualBlockGroups.end()) {
+                return;
+            }
+            const auto &residualBlockGroup = group->second;
+            removeResidualBlockId(correspondenceResiduals, residualBlockGroup.correspondence);
+            removeResidualBlockId(explicitRoadMarkResiduals, residualBlockGroup.correspondence);
+            removeResidualBlockId(lambdaResiduals, residualBlockGroup.lambda);
+
+            // Removing the parameter block removes all residual blocks that depend on it.
+            problem->RemoveParameterBlock(lambda);
+            linearSolverOrdering->Remove(const_cast<double *>(lambda));
+
+            weights.erase(std::find_if(weights.begin(), weights.end(), [&](const std::vector<double> &blockWeights) {
+                return blockWeights.data() == residualBlockGroup.weights;
+            }));
+            residualBlockGroups.erase(group);
         }
 
         ceres::ResidualBlockId
-        CameraPoseEstimationBase::addLambdaResidualBlock(ceres::Problem &problem, const ParametricPoint &point) const {
+        CameraPoseEstimationBase::addLambdaResidualBlock(ceres::Problem &problem,
+                                                         const std::vector<ParametricPoint> &points) const {
+            std::vector<ceres::CostFunction *> elementResiduals;
+            for (const auto &point: points) {
+                elementResiduals.emplace_back(
+                        residuals::DistanceFromIntervalResidual::create(point.getLambdaMin(), point.getLambdaMax()));
+            }
             return problem.AddResidualBlock(
-                    residuals::DistanceFromIntervalResidual::create(point.getLambdaMin(), point.getLambdaMax()),
-                    getScaledHuberLoss(lambdaResidualScalingFactor),
-                    point.getLambda()
+                    residuals::ElementwiseResidual::create(elementResiduals, lambdaLossFunction.get(),
+                                                           ceres::DO_NOT_TAKE_OWNERSHIP),
+                    nullptr,
+                    points.front().getLambda()
             );
         }
 
         void CameraPoseEstimationBase::addRotationConstraints(ceres::Problem &problem) {
             rotationResiduals.clear();
             rotationResiduals.emplace_back(problem.AddResidualBlock(
-                    static_calibration::calibration::residuals::DistanceFromIntervalResidual::create(60, 110),
+                    static_calibration::calibration::residuals::EulerAngleFromIntervalResidual::create(0, 60, 110),
                     getScaledHuberLoss(rotationResidualScalingFactor),
-                    &rotation.x()
+                    pose.data()
             ));
             rotationResiduals.emplace_back(problem.AddResidualBlock(
-                    static_calibration::calibration::residuals::DistanceFromIntervalResidual::create(-20, 20),
+                    static_calibration::calibration::residuals::EulerAngleFromIntervalResidual::create(1, -20, 20),
                     getScaledHuberLoss(rotationResidualScalingFactor),
-                    &rotation.y()
+                    pose.data()
             ));
         }
 
@@ -260,14 +842,14 @@ namespace static_calibration {
         void CameraPoseEstimationBase::guessRotation(const Eigen::Vector3d &value) {
             hasRotationGuess = true;
             initialRotation = value;
-            rotation = value;
+            setRotation(value);
         }
 
         template<>
         void CameraPoseEstimationBase::guessTranslation(const Eigen::Vector3d &value) {
             hasTranslationGuess = true;
             initialTranslation = value;
-            translation = value;
+            setTranslation(value);
             initialDistanceFromMean = 0;
         }
 
@@ -293,8 +875,8 @@ namespace static_calibration {
         std::ostream &operator<<(std::ostream &os, const CameraPoseEstimationBase &estimator) {
             os << "Translation:" << std::endl;
             os << "From:       " << printVectorRow(estimator.initialTranslation) << std::endl;
-            os << "To:         " << printVectorRow(estimator.translation) << std::endl;
-            os << "Difference: " << printVectorRow(estimator.translation - estimator.initialTranslation)
+            os << "To:         " << printVectorRow(estimator.getTranslation()) << std::endl;
+            os << "Difference: " << printVectorRow(estimator.getTranslation() - estimator.initialTranslation)
                << std::endl;
 
             os << "Rotation:" << std::endl;
@@ -312,6 +894,16 @@ namespace static_calibration {
             }
             os << "Difference: " << printVectorRow(intrinicsDifference) << std::endl;
 
+            const auto &covariance = estimator.poseCovariance;
+            if (covariance.valid) {
+                os << "Standard deviation:" << std::endl;
+                os << "Translation: " << printVectorRow(covariance.getTranslationDeviation()) << std::endl;
+                os << "Rotation:    " << printVectorRow(covariance.getRotationDeviation()) << std::endl;
+                os << "Intrinsics:  " << printVectorRow(covariance.getIntrinsicsDeviation()) << std::endl;
+                os << "Calculated in " << covariance.seconds << "s, the last solve took "
+                   << estimator.summary.total_time_in_seconds << "s" << std::endl;
+            }
+
 //            os << "Weights:" << std::endl;
 //            for (const auto &weight : estimator.weights) {
 //                os << *weight << ", ";
@@ -323,57 +915,232 @@ namespace static_calibration {
             return intrinsics;
         }
 
-        void CameraPoseEstimationBase::setWeightPenalizeScale(double value) {
-            weightResidualScalingFactor = value;
+        void CameraPoseEstimationBase::setParallelStarts(int value) {
+            numParallelStarts = std::max(1, value);
         }
 
-        std::vector<double> CameraPoseEstimationBase::getWeights() {
-            std::vector<double> result;
-            result.reserve(weights.size());
-            std::transform(std::begin(weights), std::end(weights),
-                           std::back_inserter(result), [](const double *weight) { return *weight; }
-            );
+        void CameraPoseEstimationBase::setSeed(std::uint64_t value) {
+            seed = value;
+        }
+
+        void CameraPoseEstimationBase::setOutlierRejectionOptions(const OutlierRejectionOptions &value) {
+            outlierRejectionOptions = value;
+        }
+
+        void CameraPoseEstimationBase::setCovarianceEnabled(bool value) {
+            covarianceEnabled = value;
+        }
+
+        void CameraPoseEstimationBase::setEarlyAbortOptions(const EarlyAbortOptions &value) {
+            earlyAbortOptions = value;
+        }
+
+        void CameraPoseEstimationBase::setLinearSolverType(ceres::LinearSolverType value) {
+            solverProfile.linearSolverType = value;
+        }
+
+        void CameraPoseEstimationBase::setCoarseToFineStages(const std::vector<CoarseToFineStage> &value) {
+            coarseToFineStages = value;
+        }
+
+        WarmStart CameraPoseEstimationBase::getWarmStart() const {
+            return {pose, intrinsics, dataSet.getLambdas()};
+        }
+
+        void CameraPoseEstimationBase::setWarmStart(const WarmStart &value) {
+            warmStart = std::make_shared<const WarmStart>(value);
+        }
+
+        void CameraPoseEstimationBase::clearWarmStart() {
+            warmStart.reset();
+        }
+
+        const SolverProfile &CameraPoseEstimationBase::getSolverProfile() const {
+            return solverProfile;
+        }
+
+        void CameraPoseEstimationBase::setSolverProfile(const SolverProfile &value) {
+            solverProfile = value;
+        }
+
+        std::vector<SolverProfileTiming>
+        CameraPoseEstimationBase::benchmarkSolverProfiles(const std::vector<SolverProfile> &candidates,
+                                                          int repetitions) {
+            const auto originalProfile = solverProfile;
+            const auto originalEarlyAbortOptions = earlyAbortOptions;
+            earlyAbortOptions = EarlyAbortOptions();
+
+            resetParameters();
+            randomEngine.seed(deriveSeed(seed, 0));
+            calculateInitialGuess();
+            const auto initialPose = pose;
+
+            std::vector<SolverProfileTiming> timings;
+            for (const auto &candidate: candidates) {
+                solverProfile = candidate;
+                SolverProfileTiming timing{candidate, std::numeric_limits<double>::infinity(), 0};
+                for (int i = 0; i < std::max(1, repetitions); i++) {
+                    resetParameters();
+                    pose = initialPose;
+                    auto start = std::chrono::steady_clock::now();
+                    solveProblem(false);
+                    std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+                    timing.seconds = std::min(timing.seconds, duration.count());
+                    timing.finalCost = summary.final_cost;
+                }
+                timings.emplace_back(timing);
+            }
+
+            solverProfile = originalProfile;
+            earlyAbortOptions = originalEarlyAbortOptions;
+            resetParameters();
+            pose = initialPose;
+            return timings;
+        }
+
+        std::vector<BatchResult> CameraPoseEstimationBase::estimateBatch(const objects::DataSet &worldMap,
+                                                                         const std::vector<BatchJob> &jobs,
+                                                                         int numWorkers) const {
+            if (numWorkers <= 0) {
+                numWorkers = ThreadBudget::getInstance().getMaxThreads();
+            }
+            numWorkers = std::max(1, std::min(numWorkers, (int) jobs.size()));
+            int threadsPerWorker = ThreadBudget::getInstance().getThreadsPerJob(numWorkers);
+
+            std::vector<std::unique_ptr<CameraPoseEstimationBase>> workers;
+            for (int i = 0; i < numWorkers; i++) {
+                workers.emplace_back(clone(worldMap));
+                auto &worker = *workers.back();
+                // Cancelling the estimator also stops the running jobs.
+                worker.parent = this;
+                if (numWorkers > 1) {
+                    // The jobs already run in parallel.
+                    worker.numParallelStarts = 1;
+                    worker.solverProfile.numThreads = threadsPerWorker;
+                }
+            }
+
+            std::vector<BatchResult> results(jobs.size());
+            std::atomic<int> nextJob{0};
+            std::mutex errorMutex;
+            std::exception_ptr error;
+
+            std::vector<std::thread> threads;
+            for (const auto &worker: workers) {
+                threads.emplace_back([&, worker = worker.get()]() {
+                    try {
+                        for (int jobIndex = nextJob++; jobIndex < jobs.size() && !isCancelled();
+                             jobIndex = nextJob++) {
+                            // Every job draws its own sequence, independent of the worker that runs it.
+                            worker->seed = deriveSeed(seed, jobIndex);
+                            results[jobIndex] = worker->estimateJob(jobs[jobIndex], initialIntrinsics);
+                        }
+                    } catch (...) {
+                        std::lock_guard<std::mutex> lock(errorMutex);
+                        if (error == nullptr) {
+                            error = std::current_exception();
+                        }
+                    }
+                });
+            }
+            for (auto &thread: threads) {
+                thread.join();
+            }
+            if (error != nullptr) {
+                std::rethrow_exception(error);
+            }
+            return results;
+        }
+
+        BatchResult CameraPoseEstimationBase::estimateJob(const BatchJob &job,
+                                                          const std::vector<double> &defaultIntrinsics) {
+            auto start = std::chrono::steady_clock::now();
+            setMappings(job.mapping, job.mappingExtension);
+            guessTranslation(job.translation);
+            guessRotation(job.rotation);
+            setIntrinsics(job.intrinsics.empty() ? defaultIntrinsics : job.intrinsics);
+            warmStart = job.warmStart;
+            estimate(false);
+            std::chrono::duration<double> duration = std::chrono::steady_clock::now() - start;
+
+            BatchResult result;
+            result.translation = getTranslation();
+            result.rotation = getRotation();
+            result.intrinsics = intrinsics;
+            result.validSolution = foundValidSolution;
+            result.covariance = poseCovariance;
+            result.totalLoss = totalLoss;
+            result.correspondencesLoss = correspondencesLoss;
+            result.explicitRoadMarksLoss = explicitRoadMarksLoss;
+            result.lambdasLoss = lambdasLoss;
+            result.intrinsicsLoss = intrinsicsLoss;
+            result.rotationsLoss = rotationsLoss;
+            result.evaluationError = dataSet.evaluate(result.translation, result.rotation, result.intrinsics);
+            result.seconds = duration.count();
             return result;
         }
 
-        double
-        CameraPoseEstimationBase::evaluate(ceres::Problem &problem,
-                                           const ceres::Problem::EvaluateOptions &evaluateOptions) {
-            double loss;
-            std::vector<double> residuals;
-            problem.Evaluate(evaluateOptions, &loss, &residuals, nullptr, nullptr);
-            return loss;
+        std::vector<double> CameraPoseEstimationBase::getWeights() {
+            std::vector<double> result;
+            for (const auto &blockWeights: weights) {
+                result.insert(result.end(), blockWeights.begin(), blockWeights.end());
+            }
+            return result;
         }
 
-        double CameraPoseEstimationBase::evaluate(ceres::Problem &problem, const std::vector<ceres::ResidualBlockId>
-        &blockIds) {
-            auto evaluateOptions = ceres::Problem::EvaluateOptions();
-            evaluateOptions.residual_blocks = blockIds;
-            return evaluate(problem, evaluateOptions);
+        void ResidualEvaluation::clear() {
+            blockIds.clear();
+            blockCosts.clear();
+            residualOffsets.assign(1, 0);
+            residuals.clear();
         }
 
-        void CameraPoseEstimationBase::evaluateAllResiduals(ceres::Problem &problem) {
-            totalLoss = evaluate(problem);
+        int ResidualEvaluation::size() const {
+            return (int) blockIds.size();
         }
 
-        void CameraPoseEstimationBase::evaluateCorrespondenceResiduals(ceres::Problem &problem) {
-            correspondencesLoss = evaluate(problem, correspondenceResiduals);
+        Eigen::Vector3d PoseCovariance::getTranslationDeviation() const {
+            return pose.diagonal().head<3>().cwiseSqrt();
         }
 
-        void CameraPoseEstimationBase::evaluateExplicitRoadMarkResiduals(ceres::Problem &problem) {
-            explicitRoadMarksLoss = evaluate(problem, explicitRoadMarkResiduals);
+        Eigen::Vector3d PoseCovariance::getRotationDeviation() const {
+            return pose.diagonal().tail<3>().cwiseSqrt() * 180. / M_PI;
         }
 
-        void CameraPoseEstimationBase::evaluateLambdaResiduals(ceres::Problem &problem) {
-            lambdasLoss = evaluate(problem, lambdaResiduals);
+        std::vector<double> PoseCovariance::getIntrinsicsDeviation() const {
+            std::vector<double> result;
+            for (int i = 0; i < 4; i++) {
+                result.emplace_back(std::sqrt(intrinsics(i, i)));
+            }
+            return result;
         }
 
-        void CameraPoseEstimationBase::evaluateWeightResiduals(ceres::Problem &problem) {
-            weightsLoss = evaluate(problem, weightResiduals);
+        double CameraPoseEstimationBase::evaluateGroup(const ceres::Problem &problem,
+                                                       const std::vector<ceres::ResidualBlockId> &blockIds) {
+            double groupLoss = 0;
+            for (const auto &blockId: blockIds) {
+                int offset = residualEvaluation.residualOffsets.back();
+                int numResiduals = problem.GetCostFunctionForResidualBlock(blockId)->num_residuals();
+                residualEvaluation.residuals.resize(offset + numResiduals);
+
+                double cost = 0;
+                problem.EvaluateResidualBlock(blockId, true, &cost, residualEvaluation.residuals.data() + offset,
+                                              nullptr);
+                residualEvaluation.blockIds.emplace_back(blockId);
+                residualEvaluation.blockCosts.emplace_back(cost);
+                residualEvaluation.residualOffsets.emplace_back(offset + numResiduals);
+                groupLoss += cost;
+            }
+            return groupLoss;
         }
 
-        void CameraPoseEstimationBase::evaluateRotationResiduals(ceres::Problem &problem) {
-            rotationsLoss = evaluate(problem, rotationResiduals);
+        void CameraPoseEstimationBase::evaluateResiduals(const ceres::Problem &problem) {
+            residualEvaluation.clear();
+            correspondencesLoss = evaluateGroup(problem, correspondenceResiduals);
+            explicitRoadMarksLoss = evaluateGroup(problem, explicitRoadMarkResiduals);
+            lambdasLoss = evaluateGroup(problem, lambdaResiduals);
+            rotationsLoss = evaluateGroup(problem, rotationResiduals);
+            totalLoss = correspondencesLoss + explicitRoadMarksLoss + lambdasLoss + rotationsLoss;
         }
 
         bool CameraPoseEstimationBase::hasFoundValidSolution() const {
@@ -396,31 +1163,51 @@ namespace static_calibration {
             return rotationsLoss;
         }
 
-        double CameraPoseEstimationBase::getWeightsLoss() const {
-            return weightsLoss;
-        }
-
         double CameraPoseEstimationBase::getTotalLoss() const {
             return totalLoss;
         }
 
+        const ResidualEvaluation &CameraPoseEstimationBase::getResidualEvaluation() const {
+            return residualEvaluation;
+        }
+
+        const PoseCovariance &CameraPoseEstimationBase::getPoseCovariance() const {
+            return poseCovariance;
+        }
+
         ceres::ResidualBlockId
         CameraPoseEstimationBase::addCorrespondenceResidualBlock(ceres::Problem &problem,
-                                                                 const ParametricPoint &point,
+                                                                 const std::vector<ParametricPoint> &points,
+                                                                 const double *weights,
                                                                  ceres::LossFunction *lossFunction) {
             // This is a mock function used only for override.
             return ceres::ResidualBlockId(-1);
         }
 
         void CameraPoseEstimationBase::setIntrinsics(const std::vector<double> &_intrinsics) {
-            intrinsics = _intrinsics;
-            if (intrinsics.size() == 4) {
-                intrinsics.emplace_back(0);
+            auto values = _intrinsics;
+            if (values.size() == 4) {
+                values.emplace_back(0);
             }
-            if (intrinsics.size() != 5) {
+            if (values.size() != 5) {
                 throw std::invalid_argument("The intrinsics need to be 5 values.");
             }
+            if (values == initialIntrinsics && intrinsics.size() == values.size()) {
+                copyIntrinsicsInPlace(values);
+                return;
+            }
+            intrinsics = values;
             initialIntrinsics = intrinsics;
+            resetProblem();
+        }
+
+        const ceres::Problem *CameraPoseEstimationBase::getProblem() const {
+            return problem.get();
+        }
+
+        void CameraPoseEstimationBase::setAnalyticJacobians(bool value) {
+            analyticJacobians = value;
+            resetProblem();
         }
 
         double CameraPoseEstimationBase::getIntrinsicsLoss() const {
@@ -428,7 +1215,8 @@ namespace static_calibration {
         }
 
         int CameraPoseEstimationBase::getCorrespondenceLossUpperBound() const {
-            return (int) weightResiduals.size();
+            return (int) (dataSet.getParametricPoints<Object>().size() +
+                          dataSet.getParametricPoints<RoadMark>().size());
         }
 
         const objects::DataSet &CameraPoseEstimationBase::getDataSet() const {
@@ -437,6 +1225,38 @@ namespace static_calibration {
 
         void CameraPoseEstimationBase::setDataSet(const objects::DataSet &dataSet) {
             CameraPoseEstimationBase::dataSet = dataSet;
+            resetProblem();
+        }
+
+        void CameraPoseEstimationBase::setMappingExtension(const std::map<std::string, std::string> &mappingExtension) {
+            // Hold the removed lambdas until their residual blocks are removed, so that no added lambda reuses their
+            // storage.
+            auto removedLambdas = dataSet.setMappingExtension(mappingExtension);
+            if (problem == nullptr) {
+                return;
+            }
+            for (const auto &lambdas: removedLambdas) {
+                for (int begin = 0; begin < lambdas->size(); begin += maxPointsPerResidualBlock) {
+                    removeResidualBlockGroup(lambdas->data() + begin);
+                }
+            }
+            addResidualBlocks(*problem, dataSet.getParametricPoints<Object>(),
+                              dataSet.getParametricPointGroups<Object>(), correspondenceResiduals, 1.0);
+            addResidualBlocks(*problem, dataSet.getParametricPoints<RoadMark>(),
+                              dataSet.getParametricPointGroups<RoadMark>(), explicitRoadMarkResiduals,
+                              (double) dataSet.getMapping().size());
+        }
+
+        void CameraPoseEstimationBase::setMappings(const std::map<std::string, std::string> &mapping,
+                                                   const std::map<std::string, std::string> &mappingExtension) {
+            if (dataSet.getMapping() == mapping) {
+                // Only the extension changed, hence keep the residual blocks of the base mapping in the problem.
+                setMappingExtension(mappingExtension);
+                return;
+            }
+            dataSet.setMappingExtension(mappingExtension);
+            dataSet.setMapping(mapping);
+            resetProblem();
         }
 
         std::string printVectorRow(std::vector<double> vector) {
@@ -456,12 +1276,19 @@ namespace static_calibration {
             return ss.str();
         }
 
-        double generateRandomNumber(double lower, double upper, int precision) {
-            long randomNumber = random();
-            int interval = (int) ((upper - lower) * std::pow(10, precision));
-            randomNumber = randomNumber % interval;
+        double generateRandomNumber(std::mt19937_64 &randomEngine, double lower, double upper, int precision) {
+            long interval = (long) ((upper - lower) * std::pow(10, precision));
+            long randomNumber = std::uniform_int_distribution<long>(0, std::max(0L, interval - 1))(randomEngine);
             double rescale = (double) randomNumber / std::pow(10., precision);
             return rescale + lower;
         }
+
+        std::uint64_t deriveSeed(std::uint64_t masterSeed, std::uint64_t jobIndex) {
+            // splitmix64, neighbouring job indices yield uncorrelated seeds.
+            std::uint64_t z = masterSeed + (jobIndex + 1) * 0x9E3779B97F4A7C15ULL;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+            return z ^ (z >> 31);
+        }
     }
 }
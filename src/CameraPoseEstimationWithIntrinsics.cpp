@@ -2,72 +2,67 @@
 // Created by brucknem on 06.07.21.
 //
 
-#include <StaticCalibration/residuals/CorrespondenceWithIntrinsicsResidual.hpp>
+#include <StaticCalibration/residuals/CorrespondenceGroupResidual.hpp>
 #include "StaticCalibration/CameraPoseEstimationWithIntrinsics.hpp"
 
 namespace static_calibration {
     namespace calibration {
 
-        void CameraPoseEstimationWithIntrinsics::evaluateIntrinsicsResiduals(ceres::Problem &problem) {
-            intrinsicsLoss = evaluate(problem, intrinsicsResiduals);
+        void CameraPoseEstimationWithIntrinsics::evaluateResiduals(const ceres::Problem &problem) {
+            CameraPoseEstimationBase::evaluateResiduals(problem);
+            intrinsicsLoss = evaluateGroup(problem, intrinsicsResiduals);
+            totalLoss += intrinsicsLoss;
         }
 
-        ceres::Problem CameraPoseEstimationWithIntrinsics::solveProblem(bool logSummary) {
-            auto problem = CameraPoseEstimationBase::solveProblem(logSummary);
-            evaluateIntrinsicsResiduals(problem);
-            return problem;
+        CameraPoseEstimationWithIntrinsics::CameraPoseEstimationWithIntrinsics(
+                const CameraPoseEstimationWithIntrinsics &other, const objects::DataSet &dataSet)
+                : CameraPoseEstimationBase(other, dataSet) {}
+
+        std::unique_ptr<CameraPoseEstimationBase>
+        CameraPoseEstimationWithIntrinsics::clone(const objects::DataSet &dataSet) const {
+            return std::unique_ptr<CameraPoseEstimationBase>(new CameraPoseEstimationWithIntrinsics(*this, dataSet));
         }
 
         void CameraPoseEstimationWithIntrinsics::resetParameters() {
-            intrinsics = initialIntrinsics;
+            copyIntrinsicsInPlace(initialIntrinsics);
             CameraPoseEstimationBase::resetParameters();
         }
 
-        ceres::Problem CameraPoseEstimationWithIntrinsics::createProblem() {
+        void CameraPoseEstimationWithIntrinsics::createProblem() {
             intrinsicsResiduals.clear();
-            auto problem = CameraPoseEstimationBase::createProblem();
-            addIntrinsicsConstraints(problem);
-
-            return problem;
+            CameraPoseEstimationBase::createProblem();
+            addIntrinsicsConstraints(*problem);
         }
 
         ceres::ResidualBlockId
         CameraPoseEstimationWithIntrinsics::addCorrespondenceResidualBlock(ceres::Problem &problem,
-                                                                           const ParametricPoint &point,
+                                                                           const std::vector<ParametricPoint> &points,
+                                                                           const double *weights,
                                                                            ceres::LossFunction *lossFunction) {
             return problem.AddResidualBlock(
-                    residuals::CorrespondenceWithIntrinsicsResidual::create(
-                            point.getExpectedPixel(),
-                            point
-                    ),
-                    lossFunction,
-                    &intrinsics[0],
-                    &intrinsics[1],
-                    &intrinsics[2],
-                    &intrinsics[3],
-                    &translation.x(),
-                    &translation.y(),
-                    &translation.z(),
-                    &rotation.x(),
-                    &rotation.y(),
-                    &rotation.z(),
-                    point.getLambda(),
-                    weights[weights.size() - 1]
+                    residuals::CorrespondenceGroupResidual::createWithIntrinsics(points, weights, lossFunction,
+                                                                                 analyticJacobians,
+                                                                                 &poseTransformCache),
+                    nullptr,
+                    intrinsics.data(),
+                    pose.data(),
+                    points.front().getLambda()
             );
         }
 
         void CameraPoseEstimationWithIntrinsics::addIntrinsicsConstraints(ceres::Problem &problem) {
-            for (int i = 0; i < intrinsics.size(); ++i) {
+            // The skew is not part of the optimized [fx, fy, cx, cy] parameter block.
+            for (int i = 0; i < 4; ++i) {
                 double lowerBound = std::max(500., initialIntrinsics[i] * 0.9);
                 double upperBound = std::max(500., initialIntrinsics[i] * 1.1);
                 double scale = getCorrespondenceLossUpperBound();
 
                 intrinsicsResiduals.emplace_back(problem.AddResidualBlock(
-                        static_calibration::calibration::residuals::DistanceFromIntervalResidual::create(
-                                lowerBound, upperBound, "intrinsics"
+                        static_calibration::calibration::residuals::DistanceFromIntervalResidual::createForIntrinsics(
+                                i, lowerBound, upperBound, "intrinsics"
                         ),
                         getScaledHuberLoss(scale),
-                        &intrinsics[i]
+                        intrinsics.data()
                 ));
             }
         }
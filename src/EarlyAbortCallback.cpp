@@ -0,0 +1,40 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#include "StaticCalibration/EarlyAbortCallback.hpp"
+
+namespace static_calibration {
+    namespace calibration {
+
+        EarlyAbortCallback::EarlyAbortCallback(const EarlyAbortOptions &options, std::atomic<double> &bestCost)
+                : options(options), bestCost(bestCost) {}
+
+        ceres::CallbackReturnType EarlyAbortCallback::operator()(const ceres::IterationSummary &summary) {
+            costs.emplace_back(summary.cost);
+            int iteration = (int) costs.size() - 1;
+
+            double currentBestCost = bestCost;
+            while (summary.cost < currentBestCost && !bestCost.compare_exchange_weak(currentBestCost, summary.cost)) {}
+
+            if (iteration >= options.minIterations) {
+                aborted = summary.cost > options.maxCost || summary.cost > options.maxRatioToBestCost * bestCost;
+                if (aborted) {
+                    return ceres::SOLVER_ABORT;
+                }
+            }
+            if (options.stallIterations > 0 && iteration >= options.stallIterations) {
+                // A stalled solve is not necessarily hopeless, hence keep its solution for the validity checks.
+                double previousCost = costs[iteration - options.stallIterations];
+                if (previousCost - summary.cost < options.minRelativeDecrease * previousCost) {
+                    return ceres::SOLVER_TERMINATE_SUCCESSFULLY;
+                }
+            }
+            return ceres::SOLVER_CONTINUE;
+        }
+
+        bool EarlyAbortCallback::hasAborted() const {
+            return aborted;
+        }
+    }
+}
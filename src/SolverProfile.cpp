@@ -0,0 +1,86 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#include "StaticCalibration/SolverProfile.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <stdexcept>
+
+namespace static_calibration {
+    namespace calibration {
+
+        void SolverProfile::apply(ceres::Solver::Options &options) const {
+            options.linear_solver_type = linearSolverType;
+            options.trust_region_strategy_type = trustRegionStrategyType;
+            options.use_nonmonotonic_steps = useNonmonotonicSteps;
+            options.max_num_iterations = maxNumIterations;
+            options.function_tolerance = functionTolerance;
+            options.gradient_tolerance = gradientTolerance;
+            options.parameter_tolerance = parameterTolerance;
+        }
+
+        int SolverProfile::getRequestedThreads(int numResidualBlocks) const {
+            if (numThreads > 0) {
+                return numThreads;
+            }
+            int blocksPerThread = std::max(1, residualBlocksPerThread);
+            return std::max(1, (numResidualBlocks + blocksPerThread - 1) / blocksPerThread);
+        }
+
+        bool SolverProfile::usesSchurComplement() const {
+            return linearSolverType == ceres::DENSE_SCHUR || linearSolverType == ceres::SPARSE_SCHUR ||
+                   linearSolverType == ceres::ITERATIVE_SCHUR;
+        }
+
+        std::string SolverProfile::toString() const {
+            std::stringstream ss;
+            ss << ceres::LinearSolverTypeToString(linearSolverType) << ", "
+               << ceres::TrustRegionStrategyTypeToString(trustRegionStrategyType)
+               << (useNonmonotonicSteps ? ", nonmonotonic" : "");
+            return ss.str();
+        }
+
+        std::vector<SolverProfile> getAutotuneCandidates(const SolverProfile &base) {
+            std::vector<SolverProfile> candidates{base};
+            for (auto linearSolverType: {ceres::SPARSE_NORMAL_CHOLESKY, ceres::DENSE_SCHUR, ceres::SPARSE_SCHUR,
+                                         ceres::ITERATIVE_SCHUR}) {
+                for (auto trustRegionStrategyType: {ceres::LEVENBERG_MARQUARDT, ceres::DOGLEG}) {
+                    SolverProfile candidate = base;
+                    candidate.linearSolverType = linearSolverType;
+                    candidate.trustRegionStrategyType = trustRegionStrategyType;
+                    candidate.useNonmonotonicSteps = false;
+                    candidates.emplace_back(candidate);
+                }
+            }
+            SolverProfile nonmonotonic = base;
+            nonmonotonic.useNonmonotonicSteps = !base.useNonmonotonicSteps;
+            candidates.emplace_back(nonmonotonic);
+            return candidates;
+        }
+
+        const SolverProfileTiming &selectFastestProfile(const std::vector<SolverProfileTiming> &timings,
+                                                        double relativeCostTolerance) {
+            if (timings.empty()) {
+                throw std::invalid_argument("No solver profile timings to select from.");
+            }
+            double lowestCost = timings.front().finalCost;
+            for (const auto &timing: timings) {
+                lowestCost = std::min(lowestCost, timing.finalCost);
+            }
+
+            const SolverProfileTiming *fastest = nullptr;
+            for (const auto &timing: timings) {
+                if (timing.finalCost > lowestCost + relativeCostTolerance * std::abs(lowestCost)) {
+                    continue;
+                }
+                if (fastest == nullptr || timing.seconds < fastest->seconds) {
+                    fastest = &timing;
+                }
+            }
+            return *fastest;
+        }
+    }
+}
@@ -0,0 +1,79 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#include "StaticCalibration/ThreadBudget.hpp"
+
+#include <algorithm>
+#include <thread>
+
+namespace static_calibration {
+    namespace calibration {
+
+        ThreadBudget::Lease::Lease(ThreadBudget *budget, int threads) : budget(budget), threads(threads) {}
+
+        ThreadBudget::Lease::Lease(Lease &&other) noexcept: budget(other.budget), threads(other.threads) {
+            other.budget = nullptr;
+        }
+
+        ThreadBudget::Lease::~Lease() {
+            if (budget != nullptr) {
+                budget->release(threads);
+            }
+        }
+
+        int ThreadBudget::Lease::getThreads() const {
+            return threads;
+        }
+
+        ThreadBudget::ThreadBudget() : context(ceres::Context::Create()) {
+            setMaxThreads(0);
+        }
+
+        ThreadBudget &ThreadBudget::getInstance() {
+            static ThreadBudget instance;
+            return instance;
+        }
+
+        void ThreadBudget::setMaxThreads(int value) {
+            if (value <= 0) {
+                value = (int) std::thread::hardware_concurrency();
+                if (value == 0) {
+                    value = 8;
+                }
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            maxThreads = value;
+            released.notify_all();
+        }
+
+        int ThreadBudget::getMaxThreads() {
+            std::lock_guard<std::mutex> lock(mutex);
+            return maxThreads;
+        }
+
+        int ThreadBudget::getThreadsPerJob(int numJobs) {
+            return std::max(1, getMaxThreads() / std::max(1, numJobs));
+        }
+
+        ceres::Context *ThreadBudget::getContext() {
+            return context.get();
+        }
+
+        ThreadBudget::Lease ThreadBudget::acquire(int requestedThreads) {
+            std::unique_lock<std::mutex> lock(mutex);
+            released.wait(lock, [this]() { return usedThreads < maxThreads; });
+            int threads = std::max(1, std::min(requestedThreads, maxThreads - usedThreads));
+            usedThreads += threads;
+            return {this, threads};
+        }
+
+        void ThreadBudget::release(int threads) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                usedThreads -= threads;
+            }
+            released.notify_all();
+        }
+    }
+}
@@ -3,197 +3,224 @@
 //
 
 #include "StaticCalibration/camera/RenderingPipeline.hpp"
-#include "ceres/ceres.h"
 #include "CMakeConfig.h"
 
+#include <algorithm>
+#include <limits>
+
 namespace static_calibration {
     namespace camera {
 
-        template<typename T>
-        Eigen::Matrix<T, 2, 1>
-        render(const T *translation, const T *rotation, const T *intrinsics, const T *vector) {
-            bool flipped;
-            return render(translation, rotation, intrinsics, vector, flipped);
+        Eigen::Vector3d getAngleAxisFromEulerAngles(const double *rotation) {
+            // Undo the Z-flip to get a proper rotation.
+            Eigen::Matrix3d rotationMatrix = getCameraRotation(rotation);
+            rotationMatrix.row(2) = -rotationMatrix.row(2);
+            const Eigen::AngleAxisd angleAxis(rotationMatrix);
+            return angleAxis.angle() * angleAxis.axis();
         }
 
-        template Eigen::Matrix<double, 2, 1>
-        render(const double *translation, const double *rotation, const double *intrinsics, const double *vector);
-
-        template Eigen::Matrix<ceres::Jet<double, 12>, 2, 1>
-        render(const ceres::Jet<double, 12> *translation, const ceres::Jet<double, 12> *rotation,
-               const ceres::Jet<double, 12> *intrinsics, const ceres::Jet<double, 12> *vector);
-
-        template Eigen::Matrix<ceres::Jet<double, 8>, 2, 1>
-        render(const ceres::Jet<double, 8> *translation, const ceres::Jet<double, 8> *rotation,
-               const ceres::Jet<double, 8> *intrinsics, const ceres::Jet<double, 8> *vector);
-
-        template<typename T>
-        Eigen::Matrix<T, 2, 1>
-        render(const T *translation, const T *rotation, const T *intrinsics, const T
-        *vector, bool &flipped) {
-//			Eigen::Matrix<T, 3, 1> translationVector{translation[0], translation[1], translation[2]};
-//			Eigen::Matrix<T, 3, 1> rotationVector{rotation[0], rotation[1], rotation[2]};
-//			Eigen::Matrix<T, 3, 1> vectorVector{vector[0], vector[1], vector[2]};
-
-//			std::cout << "Translation" << std::endl << translationVector << std::endl;
-//			std::cout << "Rotation" << std::endl << rotationVector << std::endl;
-//			std::cout << "Vector" << std::endl << vectorVector << std::endl;
-
-            Eigen::Matrix<T, 4, 1> pointInCameraSpace = toCameraSpace(translation, rotation, vector);
-//			std::cout << "Camera Space" << std::endl << pointInCameraSpace << std::endl;
-
-            bool invalid;
-            auto intrinsicsMatrix = getIntrinsicsMatrix(intrinsics, invalid);
-//			std::cout << intrinsicsMatrix << std::endl;
-
-            Eigen::Matrix<T, 3, 1> homogeneousPixel = intrinsicsMatrix * pointInCameraSpace;
-//			std::cout << "Homogeneous pixel" << std::endl << homogeneousPixel << std::endl;
-
-            bool internalFlipped;
-            Eigen::Matrix<T, 2, 1> pixel = perspectiveDivision(homogeneousPixel, internalFlipped);
-//            std::cout << "Pixel" << std::endl << pixel << std::endl;
-            flipped = internalFlipped || invalid;
-            return pixel;
+        Eigen::Matrix<double, 6, 1> getPose(const double *translation, const double *rotation) {
+            Eigen::Matrix<double, 6, 1> pose;
+            pose << translation[0], translation[1], translation[2], getAngleAxisFromEulerAngles(rotation);
+            return pose;
         }
 
-        template Eigen::Matrix<double, 2, 1>
-        render<double>(const double *, const double *, const double *, const double *, bool &);
-
-        template Eigen::Matrix<ceres::Jet<double, 12>, 2, 1>
-        render<ceres::Jet<double, 12>>(const ceres::Jet<double, 12> *, const ceres::Jet<double, 12> *,
-                                       const ceres::Jet<double, 12> *, const ceres::Jet<double, 12> *, bool &);
-
-        template Eigen::Matrix<ceres::Jet<double, 8>, 2, 1>
-        render<ceres::Jet<double, 8>>(const ceres::Jet<double, 8> *, const ceres::Jet<double, 8> *,
-                                      const ceres::Jet<double, 8> *, const ceres::Jet<double, 8> *, bool &);
-
-        template<typename T>
-        Eigen::Matrix<T, 4, 4> getCameraRotationMatrix(const T *rotation) {
-            Eigen::Matrix<T, 3, 1> rotationInRadians{-rotation[0], -rotation[1], rotation[2]};
-            rotationInRadians *= (T) (M_PI / 180);
-
-            T zero = (T) 0;
-            T one = (T) 1;
-
-            Eigen::Matrix<T, 4, 4> zAxis;
-            T theta = rotationInRadians.z();
-            zAxis << cos(theta), -sin(theta), zero, zero,
-                    sin(theta), cos(theta), zero, zero,
-                    zero, zero, one, zero,
-                    zero, zero, zero, one;
-
-            Eigen::Matrix<T, 4, 4> yAxis;
-            theta = rotationInRadians.y();
-            yAxis << cos(theta), zero, sin(theta), zero,
-                    zero, one, zero, zero,
-                    -sin(theta), zero, cos(theta), zero,
-                    zero, zero, zero, one;
-
-            Eigen::Matrix<T, 4, 4> xAxis;
-            theta = rotationInRadians.x();
-            xAxis << one, zero, zero, zero,
-                    zero, cos(theta), -sin(theta), zero,
-                    zero, sin(theta), cos(theta), zero,
-                    zero, zero, zero, one;
-
-            Eigen::Matrix<T, 4, 4> identityZFlipped;
-            identityZFlipped << one, zero, zero, zero,
-                    zero, one, zero, zero,
-                    zero, zero, -one, zero,
-                    zero, zero, zero, one;
-
-            const Eigen::Matrix<T, 4, 4> &rotationMatrix = identityZFlipped * zAxis * yAxis * xAxis;
-            return rotationMatrix;
+        /**
+         * @return The skew symmetric cross product matrix of the given vector.
+         */
+        static Eigen::Matrix3d crossProductMatrix(const Eigen::Vector3d &vector) {
+            Eigen::Matrix3d matrix;
+            matrix << 0, -vector.z(), vector.y(),
+                    vector.z(), 0, -vector.x(),
+                    -vector.y(), vector.x(), 0;
+            return matrix;
         }
 
-        template<typename T>
-        Eigen::Matrix<T, 2, 1> perspectiveDivision(const Eigen::Matrix<T, 3, 1> &vector, bool &flipped) {
-            flipped = vector[2] < (T) 0;
-            Eigen::Matrix<T, 3, 1> result = vector / (vector[2] + 1e-51);
-            return Eigen::Matrix<T, 2, 1>{result(0, 0), result(1, 0)};
+        PoseTransform getPoseTransform(const double *pose, bool withJacobian) {
+            PoseTransform transform;
+            transform.translation << pose[0], pose[1], pose[2];
+            transform.rotation = getCameraRotationFromAngleAxis(pose + 3);
+            if (!withJacobian) {
+                return transform;
+            }
+
+            const Eigen::Vector3d angleAxis{pose[3], pose[4], pose[5]};
+            const Eigen::Matrix3d angleAxisCross = crossProductMatrix(angleAxis);
+            const double thetaSquared = angleAxis.squaredNorm();
+            transform.rightJacobian = Eigen::Matrix3d::Identity();
+            if (thetaSquared > std::numeric_limits<double>::epsilon()) {
+                const double theta = std::sqrt(thetaSquared);
+                transform.rightJacobian += -(1 - std::cos(theta)) / thetaSquared * angleAxisCross +
+                                           (theta - std::sin(theta)) / (thetaSquared * theta) * angleAxisCross *
+                                           angleAxisCross;
+            } else {
+                transform.rightJacobian -= 0.5 * angleAxisCross;
+            }
+            return transform;
         }
 
-        template<typename T>
-        Eigen::Matrix<T, 4, 1> toCameraSpace(const T *translation, const T *rotation, const T *vector) {
-            // TODO Remove inverse
-            return getCameraRotationMatrix<T>(rotation).inverse() *
-                   (Eigen::Matrix<T, 4, 1>(
-                           vector[0] - translation[0],
-                           vector[1] - translation[1],
-                           vector[2] - translation[2],
-                           (T) 1));
+        Eigen::Vector2d renderWithJacobians(const double *pose, const double *intrinsics, const double *vector,
+                                            bool &flipped,
+                                            Eigen::Matrix<double, 2, 6> *jacobianPose,
+                                            Eigen::Matrix<double, 2, 4> *jacobianIntrinsics,
+                                            Eigen::Matrix<double, 2, 3> *jacobianVector) {
+            return renderWithJacobians(getPoseTransform(pose), intrinsics, vector, flipped, jacobianPose,
+                                       jacobianIntrinsics, jacobianVector);
         }
 
-        template<typename T>
-        Eigen::Matrix<T, 3, 4> getIntrinsicsMatrix(const T *intrinsics) {
-            bool invalid;
-            return getIntrinsicsMatrix(intrinsics, invalid);
+        Eigen::Vector2d renderWithJacobians(const PoseTransform &transform, const double *intrinsics,
+                                            const double *vector, bool &flipped,
+                                            Eigen::Matrix<double, 2, 6> *jacobianPose,
+                                            Eigen::Matrix<double, 2, 4> *jacobianIntrinsics,
+                                            Eigen::Matrix<double, 2, 3> *jacobianVector) {
+            const Eigen::Vector3d difference = Eigen::Map<const Eigen::Vector3d>(vector) - transform.translation;
+            const Eigen::Vector3d pointInCameraSpace = transform.rotation.transpose() * difference;
+
+            const double fx = intrinsics[0], fy = intrinsics[1], cx = intrinsics[2], cy = intrinsics[3];
+            const double depth = pointInCameraSpace.z() + 1e-51;
+            const double homogeneousU = fx * pointInCameraSpace.x() + cx * pointInCameraSpace.z();
+            const double homogeneousV = fy * pointInCameraSpace.y() + cy * pointInCameraSpace.z();
+            flipped = pointInCameraSpace.z() < 0;
+
+            // d[u, v] / d(point in camera space)
+            Eigen::Matrix<double, 2, 3> jacobianCameraSpace;
+            jacobianCameraSpace << fx / depth, 0, cx / depth - homogeneousU / (depth * depth),
+                    0, fy / depth, cy / depth - homogeneousV / (depth * depth);
+            const Eigen::Matrix<double, 2, 3> jacobianDifference =
+                    jacobianCameraSpace * transform.rotation.transpose();
+
+            if (jacobianPose != nullptr) {
+                // The point in camera space is exp(-w) * F * (p - t), hence its derivative with respect to the angle
+                // axis w is [p_c]_x * J_r(w) with the right jacobian J_r of SO(3).
+                jacobianPose->leftCols<3>() = -jacobianDifference;
+                jacobianPose->rightCols<3>() = jacobianCameraSpace * crossProductMatrix(pointInCameraSpace) *
+                                               transform.rightJacobian;
+            }
+            if (jacobianVector != nullptr) {
+                *jacobianVector = jacobianDifference;
+            }
+            if (jacobianIntrinsics != nullptr) {
+                *jacobianIntrinsics << pointInCameraSpace.x() / depth, 0, pointInCameraSpace.z() / depth, 0,
+                        0, pointInCameraSpace.y() / depth, 0, pointInCameraSpace.z() / depth;
+            }
+
+            return {homogeneousU / depth, homogeneousV / depth};
         }
 
-        template Eigen::Matrix<double, 3, 4> getIntrinsicsMatrix(const double *intrinsics);
-
-        template Eigen::Matrix<ceres::Jet<double, 12>, 3, 4>
-        getIntrinsicsMatrix(const ceres::Jet<double, 12> *intrinsics);
-
-        template<typename T>
-        Eigen::Matrix<T, 3, 4> getIntrinsicsMatrix(const T *intrinsics, bool &invalid) {
-            T zero = (T) 0;
-            invalid = intrinsics[0] < zero;
-            invalid = false;
-            return getIntrinsicsMatrixFromConfig(new T[9]{
-                    intrinsics[0], zero, intrinsics[2],
-                    zero, intrinsics[1], intrinsics[3],
-                    zero, (T) 0, (T) 1
-            });
+        int ProjectedPoints::size() const {
+            return (int) depth.size();
         }
 
-        template Eigen::Matrix<double, 3, 4> getIntrinsicsMatrix(const double *intrinsics, bool &invalid);
-
-        template Eigen::Matrix<ceres::Jet<double, 12>, 3, 4>
-        getIntrinsicsMatrix(const ceres::Jet<double, 12> *intrinsics, bool &invalid);
+        Eigen::Vector2d ProjectedPoints::getPixel(int i) const {
+            return {u[i], v[i]};
+        }
 
+        /**
+         * Projects the structure of arrays batch of points in the precision of the arrays.
+         */
         template<typename T>
-        std::vector<T> getIntrinsicsFromRealSensor(const T *intrinsics) {
-            T zero = (T) 0;
-
-            Eigen::Matrix<T, 2, 1> principalPoint = Eigen::Matrix<T, 2, 1>(
-                    intrinsics[3],
-                    intrinsics[4]
-            );
+        static void projectPointArrays(const T *translation, const double *rotation, const double *intrinsics,
+                                       const T *x, const T *y, const T *z, int numberOfPoints,
+                                       T *u, T *v, T *depth, bool *visible, const Frustum &frustum) {
+            typedef Eigen::Array<T, Eigen::Dynamic, 1> Array;
+            typedef Eigen::Map<const Array> ConstArrayMap;
+            typedef Eigen::Map<Array> ArrayMap;
+
+            const ConstArrayMap xs(x, numberOfPoints), ys(y, numberOfPoints), zs(z, numberOfPoints);
+            ArrayMap us(u, numberOfPoints), vs(v, numberOfPoints), depths(depth, numberOfPoints);
+            Eigen::Map<Eigen::Array<bool, Eigen::Dynamic, 1>> visibles(visible, numberOfPoints);
+
+            // The point in camera space is R^T * (p - t), i.e. the rows of R^T are the columns of R.
+            const Eigen::Matrix<T, 3, 3> r = getCameraRotation(rotation).cast<T>();
+            const T tx = translation[0], ty = translation[1], tz = translation[2];
+            const T fx = (T) intrinsics[0], fy = (T) intrinsics[1], cx = (T) intrinsics[2], cy = (T) intrinsics[3];
+            // 1e-51 underflows in single precision.
+            const T epsilon = std::max((T) 1e-51, std::numeric_limits<T>::min());
+
+            depths = r(0, 2) * (xs - tx) + r(1, 2) * (ys - ty) + r(2, 2) * (zs - tz);
+            us = (fx * (r(0, 0) * (xs - tx) + r(1, 0) * (ys - ty) + r(2, 0) * (zs - tz)) + cx * depths) /
+                 (depths + epsilon);
+            vs = (fy * (r(0, 1) * (xs - tx) + r(1, 1) * (ys - ty) + r(2, 1) * (zs - tz)) + cy * depths) /
+                 (depths + epsilon);
+            visibles = depths >= (T) frustum.nearPlane && depths <= (T) frustum.farPlane;
+            if (frustum.imageWidth > 0) {
+                visibles = visibles && us >= (T) 0 && us < (T) frustum.imageWidth;
+            }
+            if (frustum.imageHeight > 0) {
+                visibles = visibles && vs >= (T) 0 && vs < (T) frustum.imageHeight;
+            }
+        }
 
-            T focalLengthPXX = intrinsics[0] * (T) 1. / intrinsics[2];
-            T focalLengthPXY = intrinsics[1] * (T) 1. / intrinsics[2];
+        void projectPoints(const double *translation, const double *rotation, const double *intrinsics,
+                           const double *x, const double *y, const double *z, int numberOfPoints,
+                           double *u, double *v, double *depth, bool *visible, const Frustum &frustum) {
+            projectPointArrays(translation, rotation, intrinsics, x, y, z, numberOfPoints, u, v, depth, visible,
+                               frustum);
+        }
 
-            // TODO add skew
+        void projectPoints(const float *translation, const double *rotation, const double *intrinsics,
+                           const float *x, const float *y, const float *z, int numberOfPoints,
+                           float *u, float *v, float *depth, bool *visible, const Frustum &frustum) {
+            projectPointArrays(translation, rotation, intrinsics, x, y, z, numberOfPoints, u, v, depth, visible,
+                               frustum);
+        }
 
-            return
-                    std::vector<T>
-                            {
-                                    focalLengthPXX, focalLengthPXY, principalPoint(0, 0), principalPoint(1, 0), zero
-                            };
+        ProjectedPoints projectPoints(const double *translation, const double *rotation, const double *intrinsics,
+                                      const Eigen::Matrix<double, Eigen::Dynamic, 3> &points,
+                                      const Frustum &frustum) {
+            int numberOfPoints = (int) points.rows();
+            ProjectedPoints result;
+            result.u.resize(numberOfPoints);
+            result.v.resize(numberOfPoints);
+            result.depth.resize(numberOfPoints);
+            result.visible.resize(numberOfPoints);
+            projectPoints(translation, rotation, intrinsics,
+                          points.col(0).data(), points.col(1).data(), points.col(2).data(), numberOfPoints,
+                          result.u.data(), result.v.data(), result.depth.data(), result.visible.data(), frustum);
+            return result;
         }
 
-        template std::vector<double> getIntrinsicsFromRealSensor(const double *intrinsics);
+        Frustum::Frustum(double nearPlane, double farPlane, int imageWidth, int imageHeight)
+                : nearPlane(nearPlane), farPlane(farPlane), imageWidth(imageWidth), imageHeight(imageHeight) {}
+
+        LocalPoints::LocalPoints(const Eigen::Matrix<double, Eigen::Dynamic, 3> &points) : origin(
+                Eigen::Vector3d::Zero()) {
+            if (points.rows() > 0) {
+                origin = points.colwise().mean().transpose();
+            }
+            x = (points.col(0).array() - origin.x()).cast<float>();
+            y = (points.col(1).array() - origin.y()).cast<float>();
+            z = (points.col(2).array() - origin.z()).cast<float>();
+        }
 
-        template std::vector<ceres::Jet<double, 12>>
-        getIntrinsicsFromRealSensor(const ceres::Jet<double, 12> *intrinsics);
+        int LocalPoints::size() const {
+            return (int) x.size();
+        }
 
-        template<typename T>
-        Eigen::Matrix<T, 3, 4> getIntrinsicsMatrixFromConfig(const T *intrinsics) {
-            Eigen::Matrix<T, 3, 4> matrix;
-            T zero = T(0);
-            matrix <<
-                   intrinsics[0], intrinsics[1], intrinsics[2], zero,
-                    intrinsics[3], intrinsics[4], intrinsics[5], zero,
-                    intrinsics[6], intrinsics[7], intrinsics[8], zero;
-//            std::cout << matrix << std::endl;
-            return matrix;
+        int ProjectedPointsf::size() const {
+            return (int) depth.size();
         }
 
-        template Eigen::Matrix<double, 3, 4> getIntrinsicsMatrixFromConfig(const double *intrinsics);
+        Eigen::Vector2d ProjectedPointsf::getPixel(int i) const {
+            return {u[i], v[i]};
+        }
 
-        template Eigen::Matrix<ceres::Jet<double, 12>, 3, 4>
-        getIntrinsicsMatrixFromConfig(const ceres::Jet<double, 12> *intrinsics);
+        ProjectedPointsf projectPoints(const double *translation, const double *rotation, const double *intrinsics,
+                                       const LocalPoints &points, const Frustum &frustum) {
+            int numberOfPoints = points.size();
+            // Shift the camera in double precision so that only the small local offsets are rounded.
+            const Eigen::Vector3f localTranslation = (Eigen::Map<const Eigen::Vector3d>(translation) -
+                                                      points.origin).cast<float>();
+            ProjectedPointsf result;
+            result.u.resize(numberOfPoints);
+            result.v.resize(numberOfPoints);
+            result.depth.resize(numberOfPoints);
+            result.visible.resize(numberOfPoints);
+            projectPoints(localTranslation.data(), rotation, intrinsics,
+                          points.x.data(), points.y.data(), points.z.data(), numberOfPoints,
+                          result.u.data(), result.v.data(), result.depth.data(), result.visible.data(), frustum);
+            return result;
+        }
 
         std::vector<double> getBlenderCameraIntrinsics() {
             double pixelWidth = 32. / 1920.;
@@ -129,10 +129,12 @@ namespace static_calibration {
             }
             std::map<std::string, std::string> mapping;
             YAML::Node objectsFileYAML = loadFile(objectsFile);
+            // Unique placeholder ids of the image objects without world object, deterministic for reproducible runs.
+            int unmappedIds = 0;
             for (const auto &node: objectsFileYAML) {
                 std::string id = node.first.as<std::string>();
                 if (id == "x") {
-                    id = std::to_string(-std::rand());
+                    id = std::to_string(-(++unmappedIds));
                 }
                 mapping[id] = node.second.as<std::string>();
             }
@@ -177,19 +179,138 @@ namespace static_calibration {
             mappingExtension.clear();
         }
 
+        /**
+         * Points the parametric points to the buffers that replace the buffers they currently point into.
+         */
+        static void relinkLambdas(std::vector<calibration::ParametricPoint> &points,
+                                  const std::map<const double *, double *> &replacements) {
+            for (auto &point: points) {
+                // The buffers are contiguous, hence the buffer of a lambda is the one with the last begin before it.
+                auto replacement = replacements.upper_bound(point.getLambda());
+                if (replacement == replacements.begin()) {
+                    continue;
+                }
+                --replacement;
+                point.setLambda(replacement->second + (point.getLambda() - replacement->first));
+            }
+        }
+
+        void DataSet::detachLambdas() {
+            // Copy the buffers in place so that the order of the parametric points is kept.
+            std::map<const double *, double *> replacements;
+            for (auto &buffer: lambdas) {
+                auto copy = std::make_shared<std::vector<double>>(*buffer);
+                replacements[buffer->data()] = copy->data();
+                buffer = copy;
+            }
+            relinkLambdas(worldObjectsParametricPoints, replacements);
+            relinkLambdas(explicitRoadMarksParametricPoints, replacements);
+        }
+
+        /**
+         * Removes the group of parametric points whose lambdas are stored in the given buffer.
+         *
+         * @return true if a group was removed, false else.
+         */
+        static bool removeGroup(std::vector<calibration::ParametricPoint> &points,
+                                std::vector<std::pair<int, int>> &groups, const double *buffer) {
+            for (int i = 0; i < groups.size(); i++) {
+                if (points[groups[i].first].getLambda() != buffer) {
+                    continue;
+                }
+                int begin = groups[i].first, end = groups[i].second;
+                points.erase(points.begin() + begin, points.begin() + end);
+                groups.erase(groups.begin() + i);
+                for (int j = i; j < groups.size(); j++) {
+                    groups[j].first -= end - begin;
+                    groups[j].second -= end - begin;
+                }
+                return true;
+            }
+            return false;
+        }
+
+        void DataSet::unmerge(const std::pair<std::string, std::string> &entry,
+                              std::vector<std::shared_ptr<std::vector<double>>> &removedLambdas) {
+            for (int i = 0; i < lambdaKeys.size(); i++) {
+                if (lambdaKeys[i] != entry) {
+                    continue;
+                }
+                const double *buffer = lambdas[i]->data();
+                if (!removeGroup(worldObjectsParametricPoints, worldObjectsParametricPointGroups, buffer)) {
+                    removeGroup(explicitRoadMarksParametricPoints, explicitRoadMarksParametricPointGroups, buffer);
+                }
+                removedLambdas.emplace_back(lambdas[i]);
+                lambdas.erase(lambdas.begin() + i);
+                lambdaKeys.erase(lambdaKeys.begin() + i);
+                --i;
+            }
+        }
+
+        std::vector<Eigen::Vector2d> DataSet::getCenterLine(int imageObjectIndex) const {
+            auto centerLine = imageObjects[imageObjectIndex].getCenterLine();
+            int stride = std::max(1, rowStride);
+            if (maxPointsPerEntry > 0) {
+                stride = std::max(stride, ((int) centerLine.size() + maxPointsPerEntry - 1) / maxPointsPerEntry);
+            }
+            if (stride == 1) {
+                return centerLine;
+            }
+            std::vector<Eigen::Vector2d> result;
+            for (int i = 0; i < centerLine.size(); i += stride) {
+                result.emplace_back(centerLine[i]);
+            }
+            return result;
+        }
+
+        DataSet DataSet::subsample(int rowStride, int maxPointsPerEntry) const {
+            DataSet result = *this;
+            result.rowStride = rowStride;
+            result.maxPointsPerEntry = maxPointsPerEntry;
+            result.merge();
+            return result;
+        }
+
+        std::map<std::pair<std::string, std::string>, std::vector<double>> DataSet::getLambdas() const {
+            std::map<std::pair<std::string, std::string>, std::vector<double>> result;
+            for (int i = 0; i < lambdas.size(); i++) {
+                result[lambdaKeys[i]] = *lambdas[i];
+            }
+            return result;
+        }
+
+        int DataSet::setLambdas(const std::map<std::pair<std::string, std::string>, std::vector<double>> &values) {
+            int numSet = 0;
+            for (int i = 0; i < lambdas.size(); i++) {
+                auto value = values.find(lambdaKeys[i]);
+                if (value == values.end() || value->second.size() != lambdas[i]->size()) {
+                    continue;
+                }
+                *lambdas[i] = value->second;
+                numSet++;
+            }
+            return numSet;
+        }
+
         template<>
         void DataSet::merge<calibration::Object>(int worldObjectIndex, int imageObjectIndex) {
             if (worldObjectIndex < 0 || imageObjectIndex < 0) {
                 return;
             }
-            for (const auto &pixel: imageObjects[imageObjectIndex].getCenterLine()) {
+            const auto centerLine = getCenterLine(imageObjectIndex);
+            lambdas.emplace_back(std::make_shared<std::vector<double>>(centerLine.size(), 0));
+            lambdaKeys.emplace_back(worldObjects[worldObjectIndex].getId(), imageObjects[imageObjectIndex].getId());
+            int begin = (int) worldObjectsParametricPoints.size();
+            for (int i = 0; i < centerLine.size(); i++) {
                 worldObjectsParametricPoints.emplace_back(calibration::ParametricPoint(
-                        pixel,
+                        centerLine[i],
                         worldObjects[worldObjectIndex].getOrigin(),
                         worldObjects[worldObjectIndex].getAxis(),
-                        worldObjects[worldObjectIndex].getLength()
+                        worldObjects[worldObjectIndex].getLength(),
+                        lambdas.back()->data() + i
                 ));
             }
+            worldObjectsParametricPointGroups.emplace_back(begin, (int) worldObjectsParametricPoints.size());
         }
 
         template<>
@@ -197,14 +318,21 @@ namespace static_calibration {
             if (worldObjectIndex < 0 || imageObjectIndex < 0) {
                 return;
             }
-            for (const auto &pixel: imageObjects[imageObjectIndex].getCenterLine()) {
+            const auto centerLine = getCenterLine(imageObjectIndex);
+            lambdas.emplace_back(std::make_shared<std::vector<double>>(centerLine.size(), 0));
+            lambdaKeys.emplace_back(explicitRoadMarks[worldObjectIndex].getId(),
+                                    imageObjects[imageObjectIndex].getId());
+            int begin = (int) explicitRoadMarksParametricPoints.size();
+            for (int i = 0; i < centerLine.size(); i++) {
                 explicitRoadMarksParametricPoints.emplace_back(calibration::ParametricPoint(
-                        pixel,
+                        centerLine[i],
                         explicitRoadMarks[worldObjectIndex].getOrigin(),
                         explicitRoadMarks[worldObjectIndex].getAxis(),
-                        explicitRoadMarks[worldObjectIndex].getLength()
+                        explicitRoadMarks[worldObjectIndex].getLength(),
+                        lambdas.back()->data() + i
                 ));
             }
+            explicitRoadMarksParametricPointGroups.emplace_back(begin, (int) explicitRoadMarksParametricPoints.size());
         }
 
         template<>
@@ -245,6 +373,16 @@ namespace static_calibration {
         }
 
 
+        template<>
+        const std::vector<std::pair<int, int>> &DataSet::getParametricPointGroups<calibration::Object>() const {
+            return worldObjectsParametricPointGroups;
+        }
+
+        template<>
+        const std::vector<std::pair<int, int>> &DataSet::getParametricPointGroups<calibration::RoadMark>() const {
+            return explicitRoadMarksParametricPointGroups;
+        }
+
         template<>
         int DataSet::get<calibration::Object>(std::string id) const {
             auto objectPtr = std::find_if(worldObjects.begin(), worldObjects.end(),
@@ -291,6 +429,10 @@ namespace static_calibration {
         void DataSet::merge() {
             worldObjectsParametricPoints.clear();
             explicitRoadMarksParametricPoints.clear();
+            worldObjectsParametricPointGroups.clear();
+            explicitRoadMarksParametricPointGroups.clear();
+            lambdas.clear();
+            lambdaKeys.clear();
             auto m = getMappingExtension();
             if (m.empty()) {
                 m = getMapping();
@@ -310,7 +452,8 @@ namespace static_calibration {
         std::vector<std::map<std::string, std::string>>
         DataSet::createAllMappings(const Eigen::Vector3d &translation, const Eigen::Vector3d &rotation,
                                    const std::vector<double> &intrinsics, int maxDistance, int maxElementsInDistance,
-                                   int maxElementsPerMapping, bool sort, bool keepOnlyLongest, bool shuffle) {
+                                   int maxElementsPerMapping, bool sort, bool keepOnlyLongest, bool shuffle,
+                                   std::uint64_t seed) {
             auto extendedMapping = calculateInverseExtendedMappings(translation, rotation, intrinsics, maxDistance,
                                                                     maxElementsInDistance);
             std::vector<std::pair<std::string, std::string>> mappings;
@@ -351,7 +494,7 @@ namespace static_calibration {
             }
 
             if (shuffle) {
-                std::shuffle(result.begin(), result.end(), std::default_random_engine{});
+                std::shuffle(result.begin(), result.end(), std::default_random_engine(seed));
             }
 
             return result;
@@ -411,6 +554,15 @@ namespace static_calibration {
                                                   int maxElementsInDistance) {
             std::map<std::string, std::vector<std::pair<double, std::string>>> extendedMapping;
 
+            Eigen::Matrix<double, Eigen::Dynamic, 3> roadMarkMids(explicitRoadMarks.size(), 3);
+            for (int i = 0; i < explicitRoadMarks.size(); i++) {
+                roadMarkMids.row(i) = explicitRoadMarks[i].getMid().transpose();
+            }
+            auto projectedRoadMarks = static_calibration::camera::projectPoints(
+                    translation.data(), rotation.data(), intrinsics.data(),
+                    static_calibration::camera::LocalPoints(roadMarkMids),
+                    static_calibration::camera::Frustum(0, 1000));
+
             for (const auto &imageObject: imageObjects) {
                 bool alreadyMapped = false;
                 for (const auto &m: mapping) {
@@ -423,22 +575,16 @@ namespace static_calibration {
                     continue;
                 }
 
-                for (const auto &roadMark: explicitRoadMarks) {
-                    bool flipped;
-                    Eigen::Vector3d mid = roadMark.getMid();
-                    auto roadMarkInCameraSpace = static_calibration::camera::toCameraSpace(translation.data(),
-                                                                                           rotation.data(), mid.data());
-                    if (roadMarkInCameraSpace.z() < 0 || roadMarkInCameraSpace.z() > 1000) {
+                Eigen::Vector2d imageObjectMid = imageObject.getMid();
+                for (int i = 0; i < projectedRoadMarks.size(); i++) {
+                    if (!projectedRoadMarks.visible[i]) {
                         continue;
                     }
 
-                    auto pixel = static_calibration::camera::render(translation.data(), rotation.data(),
-                                                                    intrinsics.data(), mid.data(),
-                                                                    flipped);
-
-                    double distance = (imageObject.getMid() - pixel).norm();
+                    double distance = (imageObjectMid - projectedRoadMarks.getPixel(i)).norm();
                     if (distance <= maxDistance) {
-                        extendedMapping[imageObject.getId()].emplace_back(std::make_pair(distance, roadMark.getId()));
+                        extendedMapping[imageObject.getId()].emplace_back(
+                                std::make_pair(distance, explicitRoadMarks[i].getId()));
                     }
                 }
             }
@@ -469,9 +615,28 @@ namespace static_calibration {
             return mappingExtension;
         }
 
-        void DataSet::setMappingExtension(const std::map<std::string, std::string> &mappingExtension) {
+        std::vector<std::shared_ptr<std::vector<double>>>
+        DataSet::setMappingExtension(const std::map<std::string, std::string> &mappingExtension) {
+            std::vector<std::shared_ptr<std::vector<double>>> removedLambdas;
+            const auto before = getMergedMappings();
             DataSet::mappingExtension = mappingExtension;
-            merge();
+            const auto after = getMergedMappings();
+
+            for (const auto &entry: before) {
+                auto current = after.find(entry.first);
+                if (current == after.end() || current->second != entry.second) {
+                    unmerge(entry, removedLambdas);
+                }
+            }
+            for (const auto &entry: after) {
+                auto previous = before.find(entry.first);
+                if (previous == before.end() || previous->second != entry.second) {
+                    auto imageObjectIndex = get<calibration::ImageObject>(entry.second);
+                    merge<calibration::Object>(get<calibration::Object>(entry.first), imageObjectIndex);
+                    merge<calibration::RoadMark>(get<calibration::RoadMark>(entry.first), imageObjectIndex);
+                }
+            }
+            return removedLambdas;
         }
 
         std::map<std::string, std::string> DataSet::getMergedMappings() const {
@@ -483,19 +648,25 @@ namespace static_calibration {
         double DataSet::evaluate(const Eigen::Vector3d &translation,
                                  const Eigen::Vector3d &rotation,
                                  const std::vector<double> &intrinsics) const {
-            double error = 0;
-            for (const auto &entry: getMergedMappings()) {
-                calibration::WorldObject worldObject;
-                bool isRoadMark;
+            auto mergedMappings = getMergedMappings();
+            Eigen::Matrix<double, Eigen::Dynamic, 3> worldPositions(mergedMappings.size(), 3);
+            std::vector<Eigen::Vector2d> expectedPixels;
+            std::vector<bool> isRoadMark;
+            expectedPixels.reserve(mergedMappings.size());
+            isRoadMark.reserve(mergedMappings.size());
+
+            for (const auto &entry: mergedMappings) {
+                const calibration::WorldObject *worldObject;
+                bool roadMark;
                 int worldObjPtr = get<calibration::Object>(entry.first);
                 if (worldObjPtr >= 0) {
-                    worldObject = worldObjects[worldObjPtr];
-                    isRoadMark = false;
+                    worldObject = &worldObjects[worldObjPtr];
+                    roadMark = false;
                 } else {
                     worldObjPtr = get<calibration::RoadMark>(entry.first);
                     if (worldObjPtr >= 0) {
-                        worldObject = explicitRoadMarks[worldObjPtr];
-                        isRoadMark = true;
+                        worldObject = &explicitRoadMarks[worldObjPtr];
+                        roadMark = true;
                     } else {
                         continue;
                     }
@@ -504,17 +675,23 @@ namespace static_calibration {
                 if (imgObjPtr < 0 || worldObjPtr < 0) {
                     continue;
                 }
-                bool flipped;
-                auto actualPixel = static_calibration::camera::render(translation.data(), rotation.data(),
-                                                                      intrinsics.data(),
-                                                                      worldObject.getOrigin().data(),
-                                                                      flipped);
-                if (flipped) {
+                worldPositions.row(expectedPixels.size()) = worldObject->getOrigin().transpose();
+                expectedPixels.emplace_back(imageObjects[imgObjPtr].getMid());
+                isRoadMark.emplace_back(roadMark);
+            }
+            worldPositions.conservativeResize(expectedPixels.size(), 3);
+
+            auto projectedPoints = static_calibration::camera::projectPoints(
+                    translation.data(), rotation.data(), intrinsics.data(),
+                    static_calibration::camera::LocalPoints(worldPositions));
+
+            double error = 0;
+            for (int i = 0; i < projectedPoints.size(); i++) {
+                if (!projectedPoints.visible[i]) {
                     error += 1e5;
                 } else {
-                    auto expectedPixel = imageObjects[imgObjPtr].getMid();
-                    double distance = (actualPixel - expectedPixel).norm();
-                    if (isRoadMark) {
+                    double distance = (projectedPoints.getPixel(i) - expectedPixels[i]).norm();
+                    if (isRoadMark[i]) {
                         distance *= mapping.size();
                     }
                     error += distance;
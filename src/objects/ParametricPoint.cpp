@@ -29,6 +29,10 @@ namespace static_calibration {
             return lambda;
         }
 
+        void ParametricPoint::setLambda(double *value) {
+            lambda = value;
+        }
+
         const Eigen::Matrix<double, 2, 1> &ParametricPoint::getExpectedPixel() const {
             return expectedPixel;
         }
@@ -44,6 +48,11 @@ namespace static_calibration {
                                 0, 0,
                                 lambdaMax) {}
 
+        ParametricPoint::ParametricPoint(Eigen::Matrix<double, 2, 1> expectedPixel, Eigen::Matrix<double, 3, 1> origin,
+                                         const Eigen::Matrix<double, 3, 1> &axisA, double lambdaMax, double *lambda) :
+                expectedPixel(std::move(expectedPixel)), origin(std::move(origin)), axisA(axisA.stableNormalized()),
+                lambda(lambda), lambdaMin(0), lambdaMax(lambdaMax) {}
+
         ParametricPoint::ParametricPoint(Eigen::Matrix<double, 2, 1> expectedPixel, Eigen::Matrix<double, 3, 1> origin)
                 : ParametricPoint(expectedPixel, origin, {0, 0, 0}, 0) {}
 
@@ -0,0 +1,61 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#include "StaticCalibration/residuals/AnalyticCorrespondenceResidual.hpp"
+
+#include <utility>
+#include "StaticCalibration/camera/RenderingPipeline.hpp"
+
+namespace static_calibration {
+    namespace calibration {
+        namespace residuals {
+            AnalyticCorrespondenceResidual::AnalyticCorrespondenceResidual(Eigen::Matrix<double, 2, 1> expectedPixel,
+                                                                           const ParametricPoint &point,
+                                                                           std::vector<double> intrinsics)
+                    : CorrespondenceResidualBase(std::move(expectedPixel), point), intrinsics(std::move(intrinsics)) {
+                if (this->intrinsics.size() == 4) {
+                    this->intrinsics.emplace_back(1);
+                }
+            }
+
+            bool AnalyticCorrespondenceResidual::Evaluate(double const *const *parameters, double *residuals,
+                                                          double **jacobians) const {
+                const double *pose = parameters[0];
+                const double lambda = parameters[1][0];
+                const Eigen::Vector3d point = parametricPoint.getOrigin() + parametricPoint.getAxisA() * lambda;
+
+                Eigen::Matrix<double, 2, 6> jacobianPose;
+                Eigen::Matrix<double, 2, 3> jacobianPoint;
+                bool flipped;
+                Eigen::Vector2d actualPixel = static_calibration::camera::renderWithJacobians(
+                        pose, intrinsics.data(), point.data(), flipped, &jacobianPose, nullptr, &jacobianPoint);
+
+                Eigen::Vector2d difference = expectedPixel - actualPixel;
+                residuals[0] = difference.x();
+                residuals[1] = difference.y();
+
+                if (jacobians == nullptr) {
+                    return !flipped;
+                }
+
+                if (jacobians[0] != nullptr) {
+                    Eigen::Map<Eigen::Matrix<double, 2, 6, Eigen::RowMajor>> jacobian(jacobians[0]);
+                    jacobian = -jacobianPose;
+                }
+                if (jacobians[1] != nullptr) {
+                    Eigen::Map<Eigen::Vector2d> jacobian(jacobians[1]);
+                    jacobian = -jacobianPoint * parametricPoint.getAxisA();
+                }
+
+                return !flipped;
+            }
+
+            ceres::CostFunction *
+            AnalyticCorrespondenceResidual::create(const Eigen::Matrix<double, 2, 1> &expectedPixel,
+                                                   const ParametricPoint &point, const std::vector<double> &intrinsics) {
+                return new AnalyticCorrespondenceResidual(expectedPixel, point, intrinsics);
+            }
+        }
+    }
+}
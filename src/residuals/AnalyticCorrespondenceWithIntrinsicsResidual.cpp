@@ -0,0 +1,67 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#include "StaticCalibration/residuals/AnalyticCorrespondenceWithIntrinsicsResidual.hpp"
+
+#include <utility>
+#include "StaticCalibration/camera/RenderingPipeline.hpp"
+
+namespace static_calibration {
+    namespace calibration {
+        namespace residuals {
+            AnalyticCorrespondenceWithIntrinsicsResidual::AnalyticCorrespondenceWithIntrinsicsResidual(
+                    Eigen::Matrix<double, 2, 1> expectedPixel, const ParametricPoint &point)
+                    : CorrespondenceResidualBase(std::move(expectedPixel), point) {}
+
+            bool AnalyticCorrespondenceWithIntrinsicsResidual::Evaluate(double const *const *parameters,
+                                                                        double *residuals,
+                                                                        double **jacobians) const {
+                const double intrinsics[5] = {parameters[0][0], parameters[0][1], parameters[0][2], parameters[0][3],
+                                              0};
+                const double *pose = parameters[1];
+                const double lambda = parameters[2][0];
+                const Eigen::Vector3d point = parametricPoint.getOrigin() + parametricPoint.getAxisA() * lambda;
+
+                Eigen::Matrix<double, 2, 6> jacobianPose;
+                Eigen::Matrix<double, 2, 4> jacobianIntrinsics;
+                Eigen::Matrix<double, 2, 3> jacobianPoint;
+                bool flipped;
+                Eigen::Vector2d actualPixel = static_calibration::camera::renderWithJacobians(
+                        pose, intrinsics, point.data(), flipped, &jacobianPose, &jacobianIntrinsics, &jacobianPoint);
+
+                Eigen::Vector2d difference = expectedPixel - actualPixel;
+                residuals[0] = difference.x();
+                residuals[1] = difference.y();
+                residuals[2] = (intrinsics[0] - intrinsics[1]) * 5e-3;
+
+                if (jacobians == nullptr) {
+                    return !flipped;
+                }
+
+                if (jacobians[0] != nullptr) {
+                    Eigen::Map<Eigen::Matrix<double, 3, 4, Eigen::RowMajor>> jacobian(jacobians[0]);
+                    jacobian.topRows<2>() = -jacobianIntrinsics;
+                    jacobian.row(2) << 5e-3, -5e-3, 0, 0;
+                }
+                if (jacobians[1] != nullptr) {
+                    Eigen::Map<Eigen::Matrix<double, 3, 6, Eigen::RowMajor>> jacobian(jacobians[1]);
+                    jacobian.topRows<2>() = -jacobianPose;
+                    jacobian.row(2).setZero();
+                }
+                if (jacobians[2] != nullptr) {
+                    Eigen::Map<Eigen::Vector3d> jacobian(jacobians[2]);
+                    jacobian << -jacobianPoint * parametricPoint.getAxisA(), 0;
+                }
+
+                return !flipped;
+            }
+
+            ceres::CostFunction *
+            AnalyticCorrespondenceWithIntrinsicsResidual::create(const Eigen::Matrix<double, 2, 1> &expectedPixel,
+                                                                 const ParametricPoint &point) {
+                return new AnalyticCorrespondenceWithIntrinsicsResidual(expectedPixel, point);
+            }
+        }
+    }
+}
@@ -0,0 +1,211 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#include "StaticCalibration/residuals/CorrespondenceGroupResidual.hpp"
+
+#include <algorithm>
+#include <utility>
+#include "StaticCalibration/residuals/CorrespondenceResidual.hpp"
+#include "StaticCalibration/residuals/CorrespondenceWithIntrinsicsResidual.hpp"
+#include "StaticCalibration/residuals/RobustLoss.hpp"
+
+namespace static_calibration {
+    namespace calibration {
+        namespace residuals {
+            CorrespondenceGroupResidual::CorrespondenceGroupResidual(std::vector<ParametricPoint> points,
+                                                                     std::vector<double> intrinsics,
+                                                                     const double *weights,
+                                                                     ceres::LossFunction *lossFunction,
+                                                                     bool analyticJacobians,
+                                                                     const PoseTransformCache *poseTransformCache)
+                    : points(std::move(points)), intrinsics(std::move(intrinsics)), weights(weights),
+                      lossFunction(lossFunction), analyticJacobians(analyticJacobians),
+                      poseTransformCache(poseTransformCache) {
+                int numPoints = (int) this->points.size();
+                residualsPerPoint = hasIntrinsicsBlock() ? 3 : 2;
+                set_num_residuals(residualsPerPoint * numPoints);
+
+                if (hasIntrinsicsBlock()) {
+                    mutable_parameter_block_sizes()->emplace_back(4);
+                    pointBlockSizes.emplace_back(4);
+                }
+                for (int size: {6, numPoints}) {
+                    mutable_parameter_block_sizes()->emplace_back(size);
+                }
+                for (int size: {6, 1}) {
+                    pointBlockSizes.emplace_back(size);
+                }
+
+                if (analyticJacobians) {
+                    return;
+                }
+                for (const auto &point: this->points) {
+                    if (hasIntrinsicsBlock()) {
+                        pointResiduals.emplace_back(
+                                CorrespondenceWithIntrinsicsResidual::create(point.getExpectedPixel(), point));
+                    } else {
+                        pointResiduals.emplace_back(
+                                CorrespondenceResidual::create(point.getExpectedPixel(), point, this->intrinsics));
+                    }
+                }
+            }
+
+            bool CorrespondenceGroupResidual::hasIntrinsicsBlock() const {
+                return intrinsics.empty();
+            }
+
+            bool CorrespondenceGroupResidual::Evaluate(double const *const *parameters, double *residuals,
+                                                       double **jacobians) const {
+                const int numPoints = (int) points.size();
+                const int numBlocks = (int) pointBlockSizes.size();
+                const int poseIndex = hasIntrinsicsBlock() ? 1 : 0;
+                const int lambdasIndex = poseIndex + 1;
+
+                static_calibration::camera::PoseTransform transform;
+                const static_calibration::camera::PoseTransform *cachedTransform = nullptr;
+                if (analyticJacobians && poseTransformCache != nullptr) {
+                    cachedTransform = poseTransformCache->getTransform(parameters[poseIndex], jacobians != nullptr);
+                }
+                if (cachedTransform == nullptr) {
+                    if (analyticJacobians) {
+                        transform = static_calibration::camera::getPoseTransform(parameters[poseIndex],
+                                                                                 jacobians != nullptr);
+                    }
+                    cachedTransform = &transform;
+                }
+
+                // The buffers of a single point are reused for all points, hence an evaluation does not allocate.
+                double pointJacobians[maxPointBlocks][maxResidualsPerPoint * maxPointBlockSize];
+                double *pointJacobianPointers[maxPointBlocks] = {nullptr};
+                double **pointJacobianArray = nullptr;
+                if (jacobians != nullptr) {
+                    for (int i = 0; i < numBlocks; i++) {
+                        pointJacobianPointers[i] = jacobians[i] == nullptr ? nullptr : pointJacobians[i];
+                    }
+                    pointJacobianArray = pointJacobianPointers;
+                    if (jacobians[lambdasIndex] != nullptr) {
+                        std::fill_n(jacobians[lambdasIndex], num_residuals() * numPoints, 0.);
+                    }
+                }
+
+                bool valid = true;
+                const double *pointParameters[maxPointBlocks];
+                std::copy_n(parameters, numBlocks, pointParameters);
+                for (int p = 0; p < numPoints; p++) {
+                    pointParameters[lambdasIndex] = parameters[lambdasIndex] + p;
+                    double *pointResidual = residuals + p * residualsPerPoint;
+                    valid &= evaluatePoint(p, pointParameters, *cachedTransform, pointResidual, pointJacobianArray);
+                    if (weights != nullptr) {
+                        // Only the [u, v] pixel error is weighted, not the error of the intrinsics.
+                        applyWeight(weights[p], pointResidual, pointJacobianArray);
+                    }
+                    applyLossFunction(lossFunction.get(), residualsPerPoint, pointResidual, pointJacobianArray,
+                                      pointBlockSizes);
+
+                    if (jacobians == nullptr) {
+                        continue;
+                    }
+                    for (int i = 0; i < numBlocks; i++) {
+                        if (jacobians[i] == nullptr) {
+                            continue;
+                        }
+                        int blockSize = parameter_block_sizes()[i];
+                        int column = i == lambdasIndex ? p : 0;
+                        for (int r = 0; r < residualsPerPoint; r++) {
+                            std::copy_n(pointJacobians[i] + r * pointBlockSizes[i], pointBlockSizes[i],
+                                        jacobians[i] + (p * residualsPerPoint + r) * blockSize + column);
+                        }
+                    }
+                }
+                return valid;
+            }
+
+            bool CorrespondenceGroupResidual::evaluatePoint(int index, double const *const *parameters,
+                                                            const static_calibration::camera::PoseTransform &transform,
+                                                            double *residuals, double **jacobians) const {
+                if (!analyticJacobians) {
+                    return pointResiduals[index]->Evaluate(parameters, residuals, jacobians);
+                }
+
+                const int poseIndex = hasIntrinsicsBlock() ? 1 : 0;
+                const double *pointIntrinsics = hasIntrinsicsBlock() ? parameters[0] : intrinsics.data();
+                const double lambda = parameters[poseIndex + 1][0];
+                const ParametricPoint &parametricPoint = points[index];
+                const Eigen::Vector3d point = parametricPoint.getOrigin() + parametricPoint.getAxisA() * lambda;
+
+                Eigen::Matrix<double, 2, 6> jacobianPose;
+                Eigen::Matrix<double, 2, 4> jacobianIntrinsics;
+                Eigen::Matrix<double, 2, 3> jacobianPoint;
+                bool flipped;
+                Eigen::Vector2d actualPixel = static_calibration::camera::renderWithJacobians(
+                        transform, pointIntrinsics, point.data(), flipped, &jacobianPose,
+                        hasIntrinsicsBlock() ? &jacobianIntrinsics : nullptr, &jacobianPoint);
+
+                Eigen::Vector2d difference = parametricPoint.getExpectedPixel() - actualPixel;
+                residuals[0] = difference.x();
+                residuals[1] = difference.y();
+                if (hasIntrinsicsBlock()) {
+                    residuals[2] = (pointIntrinsics[0] - pointIntrinsics[1]) * 5e-3;
+                }
+
+                if (jacobians == nullptr) {
+                    return !flipped;
+                }
+
+                typedef Eigen::Map<Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor>> JacobianMap;
+                if (hasIntrinsicsBlock() && jacobians[0] != nullptr) {
+                    JacobianMap jacobian(jacobians[0], 3, 4);
+                    jacobian.topRows<2>() = -jacobianIntrinsics;
+                    jacobian.row(2) << 5e-3, -5e-3, 0, 0;
+                }
+                if (jacobians[poseIndex] != nullptr) {
+                    JacobianMap jacobian(jacobians[poseIndex], residualsPerPoint, 6);
+                    jacobian.setZero();
+                    jacobian.topRows<2>() = -jacobianPose;
+                }
+                if (jacobians[poseIndex + 1] != nullptr) {
+                    Eigen::Map<Eigen::VectorXd> jacobian(jacobians[poseIndex + 1], residualsPerPoint);
+                    jacobian.setZero();
+                    jacobian.head<2>() = -jacobianPoint * parametricPoint.getAxisA();
+                }
+
+                return !flipped;
+            }
+
+            void CorrespondenceGroupResidual::applyWeight(double weight, double *residuals, double **jacobians) const {
+                residuals[0] *= weight;
+                residuals[1] *= weight;
+                if (jacobians == nullptr) {
+                    return;
+                }
+                for (int i = 0; i < pointBlockSizes.size(); i++) {
+                    if (jacobians[i] != nullptr) {
+                        std::for_each(jacobians[i], jacobians[i] + 2 * pointBlockSizes[i],
+                                      [weight](double &value) { value *= weight; });
+                    }
+                }
+            }
+
+            ceres::CostFunction *CorrespondenceGroupResidual::create(const std::vector<ParametricPoint> &points,
+                                                                     const std::vector<double> &intrinsics,
+                                                                     const double *weights,
+                                                                     ceres::LossFunction *lossFunction,
+                                                                     bool analyticJacobians,
+                                                                     const PoseTransformCache *poseTransformCache) {
+                return new CorrespondenceGroupResidual(points, intrinsics, weights, lossFunction, analyticJacobians,
+                                                       poseTransformCache);
+            }
+
+            ceres::CostFunction *
+            CorrespondenceGroupResidual::createWithIntrinsics(const std::vector<ParametricPoint> &points,
+                                                              const double *weights,
+                                                              ceres::LossFunction *lossFunction,
+                                                              bool analyticJacobians,
+                                                              const PoseTransformCache *poseTransformCache) {
+                return new CorrespondenceGroupResidual(points, {}, weights, lossFunction, analyticJacobians,
+                                                       poseTransformCache);
+            }
+        }
+    }
+}
@@ -19,15 +19,21 @@ namespace static_calibration {
                     : lowerBound(
                     lowerBound), upperBound(upperBound), name(std::move(name)) {}
 
+            DistanceFromIntervalResidual::DistanceFromIntervalResidual(int index, double lowerBound, double upperBound,
+                                                                       std::string name)
+                    : DistanceFromIntervalResidual(lowerBound, upperBound, std::move(name)) {
+                this->index = index;
+            }
+
             template<typename T>
             bool DistanceFromIntervalResidual::operator()(const T *value, T *residual) const {
 //                if (name == "intrinsics") {
 //                    std::cout << name << std::endl;
 //                }
-                if (value[0] > (T) upperBound) {
-                    residual[0] = value[0] - (T) upperBound;
-                } else if (value[0] < (T) lowerBound) {
-                    residual[0] = value[0] - (T) lowerBound;
+                if (value[index] > (T) upperBound) {
+                    residual[0] = value[index] - (T) upperBound;
+                } else if (value[index] < (T) lowerBound) {
+                    residual[0] = value[index] - (T) lowerBound;
                 } else {
                     residual[0] = (T) 0;
                 }
@@ -47,6 +53,17 @@ namespace static_calibration {
                 );
             }
 
+            ceres::CostFunction *
+            DistanceFromIntervalResidual::createForIntrinsics(int index, double lowerBound, double upperBound,
+                                                              std::string name) {
+                return new ceres::AutoDiffCostFunction<DistanceFromIntervalResidual, 1, 4>(
+                        new DistanceFromIntervalResidual(index, lowerBound, upperBound, std::move(name))
+                );
+            }
+
+            template bool DistanceFromIntervalResidual::operator()(const ceres::Jet<double, 4> *, ceres::Jet<double, 4>
+            *) const;
+
             template bool DistanceFromIntervalResidual::operator()(const ceres::Jet<double, 1> *, ceres::Jet<double, 1>
             *) const;
 
@@ -0,0 +1,56 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#include "StaticCalibration/residuals/ElementwiseResidual.hpp"
+#include "StaticCalibration/residuals/RobustLoss.hpp"
+
+namespace static_calibration {
+    namespace calibration {
+        namespace residuals {
+            ElementwiseResidual::ElementwiseResidual(const std::vector<ceres::CostFunction *> &elementResiduals,
+                                                     ceres::LossFunction *lossFunction,
+                                                     ceres::Ownership ownership)
+                    : lossFunction(lossFunction) {
+                if (ownership == ceres::TAKE_OWNERSHIP) {
+                    ownedLossFunction.reset(lossFunction);
+                }
+                for (auto elementResidual: elementResiduals) {
+                    this->elementResiduals.emplace_back(elementResidual);
+                }
+                set_num_residuals((int) elementResiduals.size());
+                mutable_parameter_block_sizes()->emplace_back((int) elementResiduals.size());
+            }
+
+            bool ElementwiseResidual::Evaluate(double const *const *parameters, double *residuals,
+                                               double **jacobians) const {
+                const int numElements = num_residuals();
+                if (jacobians != nullptr && jacobians[0] != nullptr) {
+                    std::fill_n(jacobians[0], numElements * numElements, 0.);
+                }
+
+                const std::vector<int> elementBlockSizes{1};
+                for (int i = 0; i < numElements; i++) {
+                    const double *element = parameters[0] + i;
+                    double *elementJacobian = nullptr;
+                    if (jacobians != nullptr && jacobians[0] != nullptr) {
+                        elementJacobian = jacobians[0] + i * numElements + i;
+                    }
+                    if (!elementResiduals[i]->Evaluate(&element, residuals + i,
+                                                       elementJacobian == nullptr ? nullptr : &elementJacobian)) {
+                        return false;
+                    }
+                    applyLossFunction(lossFunction, 1, residuals + i,
+                                      elementJacobian == nullptr ? nullptr : &elementJacobian, elementBlockSizes);
+                }
+                return true;
+            }
+
+            ceres::CostFunction *ElementwiseResidual::create(const std::vector<ceres::CostFunction *> &elementResiduals,
+                                                             ceres::LossFunction *lossFunction,
+                                                             ceres::Ownership ownership) {
+                return new ElementwiseResidual(elementResiduals, lossFunction, ownership);
+            }
+        }
+    }
+}
@@ -0,0 +1,43 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#include "StaticCalibration/residuals/EulerAngleFromIntervalResidual.hpp"
+
+#include "StaticCalibration/camera/RenderingPipeline.hpp"
+
+namespace static_calibration {
+    namespace calibration {
+        namespace residuals {
+
+            EulerAngleFromIntervalResidual::EulerAngleFromIntervalResidual(int axis, double lowerBound,
+                                                                           double upperBound)
+                    : axis(axis), lowerBound(lowerBound), upperBound(upperBound) {}
+
+            template<typename T>
+            bool EulerAngleFromIntervalResidual::operator()(const T *pose, T *residual) const {
+                const T value = static_calibration::camera::getEulerAnglesFromAngleAxis(pose + 3)[axis];
+                if (value > (T) upperBound) {
+                    residual[0] = value - (T) upperBound;
+                } else if (value < (T) lowerBound) {
+                    residual[0] = value - (T) lowerBound;
+                } else {
+                    residual[0] = (T) 0;
+                }
+                return true;
+            }
+
+            ceres::CostFunction *
+            EulerAngleFromIntervalResidual::create(int axis, double lowerBound, double upperBound) {
+                return new ceres::AutoDiffCostFunction<EulerAngleFromIntervalResidual, 1, 6>(
+                        new EulerAngleFromIntervalResidual(axis, lowerBound, upperBound)
+                );
+            }
+
+            template bool EulerAngleFromIntervalResidual::operator()(const ceres::Jet<double, 6> *,
+                                                                     ceres::Jet<double, 6> *) const;
+
+            template bool EulerAngleFromIntervalResidual::operator()(const double *, double *) const;
+        }
+    }
+}
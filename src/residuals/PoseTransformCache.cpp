@@ -0,0 +1,35 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#include "StaticCalibration/residuals/PoseTransformCache.hpp"
+
+namespace static_calibration {
+    namespace calibration {
+        namespace residuals {
+            PoseTransformCache::PoseTransformCache(const double *pose) : pose(pose) {}
+
+            void PoseTransformCache::PrepareForEvaluation(bool evaluateJacobians, bool newEvaluationPoint) {
+                // The solver may request the jacobians at a point whose residuals it evaluated before.
+                if (valid && !newEvaluationPoint && (hasJacobian || !evaluateJacobians)) {
+                    return;
+                }
+                cachedPose = Eigen::Map<const Eigen::Matrix<double, 6, 1>>(pose);
+                // The residual only evaluations of the step candidates do not need the right jacobian.
+                transform = static_calibration::camera::getPoseTransform(cachedPose.data(), evaluateJacobians);
+                hasJacobian = evaluateJacobians;
+                valid = true;
+            }
+
+            const static_calibration::camera::PoseTransform *
+            PoseTransformCache::getTransform(const double *evaluatedPose, bool withJacobian) const {
+                // Guards against evaluations outside of the solver, e.g. by the gradient checker.
+                if (!valid || (withJacobian && !hasJacobian) ||
+                    cachedPose != Eigen::Map<const Eigen::Matrix<double, 6, 1>>(evaluatedPose)) {
+                    return nullptr;
+                }
+                return &transform;
+            }
+        }
+    }
+}
@@ -0,0 +1,58 @@
+//
+// Created by brucknem on 16.10.26.
+//
+
+#include "StaticCalibration/residuals/RobustLoss.hpp"
+
+#include <cmath>
+
+namespace static_calibration {
+    namespace calibration {
+        namespace residuals {
+
+            void applyLossFunction(const ceres::LossFunction *lossFunction, int numResiduals, double *residuals,
+                                   double **jacobians, const std::vector<int> &blockSizes) {
+                if (lossFunction == nullptr) {
+                    return;
+                }
+
+                double squaredNorm = 0;
+                for (int r = 0; r < numResiduals; r++) {
+                    squaredNorm += residuals[r] * residuals[r];
+                }
+                double rho[3];
+                lossFunction->Evaluate(squaredNorm, rho);
+
+                // r' = g(s) * r with g(s) = sqrt(rho(s) / s), hence dr' = g * dr + 2 * g'(s) * r * r^T * dr.
+                double scale = std::sqrt(rho[1]);
+                double correction = 0;
+                if (squaredNorm > 0) {
+                    scale = std::sqrt(rho[0] / squaredNorm);
+                    correction = (rho[1] - rho[0] / squaredNorm) / squaredNorm / scale;
+                }
+
+                if (jacobians != nullptr) {
+                    for (int i = 0; i < blockSizes.size(); i++) {
+                        if (jacobians[i] == nullptr) {
+                            continue;
+                        }
+                        for (int c = 0; c < blockSizes[i]; c++) {
+                            double projection = 0;
+                            for (int r = 0; r < numResiduals; r++) {
+                                projection += residuals[r] * jacobians[i][r * blockSizes[i] + c];
+                            }
+                            for (int r = 0; r < numResiduals; r++) {
+                                double &value = jacobians[i][r * blockSizes[i] + c];
+                                value = scale * value + correction * residuals[r] * projection;
+                            }
+                        }
+                    }
+                }
+
+                for (int r = 0; r < numResiduals; r++) {
+                    residuals[r] *= scale;
+                }
+            }
+        }
+    }
+}
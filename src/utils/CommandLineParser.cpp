@@ -17,7 +17,7 @@
 #include <fstream>
 #include <yaml-cpp/yaml.h>
 #include <StaticCalibration/utils/RenderUtils.hpp>
-#include <boost/filesystem/path.hpp>
+#include <boost/filesystem.hpp>
 
 
 namespace static_calibration {
@@ -39,6 +39,25 @@ namespace static_calibration {
                      "For explanations about the config files read the Readme.md or visit: \n"
                      "https://github.com/Brucknem/OpenDRIVE");
 
+            desc.add_options()
+                    ("autotune",
+                     "Time a fixed set of solver profiles on the data set instead of running the calibration. "
+                     "Writes the fastest profile that reaches the lowest cost to solver.yaml in the output directory.");
+
+            desc.add_options()
+                    ("solver-profile", boost::program_options::value<std::string>(),
+                     "The path to a solver profile written by --autotune. Defaults to solver.yaml in the output "
+                     "directory, which is loaded if it exists and overrides the solver section of the config.");
+
+            desc.add_options()
+                    ("linear-solver", boost::program_options::value<std::string>(),
+                     "The linear solver, overrides the solver profile.");
+
+            desc.add_options()
+                    ("compare-coarse-to-fine",
+                     "Compare the time and the final loss of the estimation with the coarse_to_fine stages of the config "
+                     "to a single estimation on all correspondences instead of running the calibration.");
+
             return desc;
         }
 
@@ -68,6 +87,140 @@ namespace static_calibration {
             }
         }
 
+        /**
+         * Parses the optional early_abort section of the config.
+         */
+        calibration::EarlyAbortOptions parseEarlyAbortOptions(const YAML::Node &config) {
+            calibration::EarlyAbortOptions options;
+            YAML::Node node = config["early_abort"];
+            if (!node.IsDefined()) {
+                return options;
+            }
+            options.minIterations = getOrDefault(node, "min_iterations", options.minIterations);
+            options.maxCost = getOrDefault(node, "max_cost", options.maxCost);
+            options.stallIterations = getOrDefault(node, "stall_iterations", options.stallIterations);
+            options.minRelativeDecrease = getOrDefault(node, "min_relative_decrease", options.minRelativeDecrease);
+            options.maxRatioToBestCost = getOrDefault(node, "max_ratio_to_best_cost", options.maxRatioToBestCost);
+            return options;
+        }
+
+        /**
+         * Parses the optional outlier_rejection section of the config.
+         */
+        calibration::OutlierRejectionOptions parseOutlierRejectionOptions(const YAML::Node &config) {
+            calibration::OutlierRejectionOptions options;
+            YAML::Node node = config["outlier_rejection"];
+            if (!node.IsDefined()) {
+                return options;
+            }
+            options.maxRounds = getOrDefault(node, "max_rounds", options.maxRounds);
+            options.thresholdScale = getOrDefault(node, "threshold_scale", options.thresholdScale);
+            options.minThreshold = getOrDefault(node, "min_threshold", options.minThreshold);
+            options.maxOutlierRatio = getOrDefault(node, "max_outlier_ratio", options.maxOutlierRatio);
+            options.reweight = getOrDefault(node, "reweight", options.reweight);
+            return options;
+        }
+
+        /**
+         * Parses the optional solver section of the config.
+         *
+         * @param config The config that contains the solver section.
+         * @param profile The profile whose values are overridden by the values of the solver section.
+         */
+        calibration::SolverProfile parseSolverProfile(const YAML::Node &config, calibration::SolverProfile profile) {
+            const YAML::Node &node = config["solver"];
+            if (!node.IsDefined()) {
+                return profile;
+            }
+
+            auto linearSolver = getOrDefault(node, "linear_solver",
+                                             std::string(ceres::LinearSolverTypeToString(profile.linearSolverType)));
+            if (!ceres::StringToLinearSolverType(linearSolver, &profile.linearSolverType)) {
+                throw std::invalid_argument("Unknown linear solver: " + linearSolver);
+            }
+            auto trustRegionStrategy = getOrDefault(node, "trust_region_strategy", std::string(
+                    ceres::TrustRegionStrategyTypeToString(profile.trustRegionStrategyType)));
+            if (!ceres::StringToTrustRegionStrategyType(trustRegionStrategy, &profile.trustRegionStrategyType)) {
+                throw std::invalid_argument("Unknown trust region strategy: " + trustRegionStrategy);
+            }
+            profile.useNonmonotonicSteps = getOrDefault(node, "use_nonmonotonic_steps", profile.useNonmonotonicSteps);
+            profile.maxNumIterations = getOrDefault(node, "max_iterations", profile.maxNumIterations);
+            profile.numThreads = getOrDefault(node, "num_threads", profile.numThreads);
+            profile.residualBlocksPerThread = getOrDefault(node, "residual_blocks_per_thread",
+                                                           profile.residualBlocksPerThread);
+            profile.functionTolerance = getOrDefault(node, "function_tolerance", profile.functionTolerance);
+            profile.gradientTolerance = getOrDefault(node, "gradient_tolerance", profile.gradientTolerance);
+            profile.parameterTolerance = getOrDefault(node, "parameter_tolerance", profile.parameterTolerance);
+            return profile;
+        }
+
+        /**
+         * Parses the optional coarse_to_fine list of stages of the config.
+         */
+        std::vector<calibration::CoarseToFineStage> parseCoarseToFineStages(const YAML::Node &config) {
+            std::vector<calibration::CoarseToFineStage> stages;
+            for (const auto &node: config["coarse_to_fine"]) {
+                calibration::CoarseToFineStage stage;
+                stage.rowStride = getOrDefault(node, "row_stride", stage.rowStride);
+                stage.maxPointsPerEntry = getOrDefault(node, "max_points_per_object", stage.maxPointsPerEntry);
+                stages.emplace_back(stage);
+            }
+            return stages;
+        }
+
+        calibration::SolverProfile readSolverProfile(const std::string &filename,
+                                                     const calibration::SolverProfile &solverProfile) {
+            return parseSolverProfile(YAML::LoadFile(filename), solverProfile);
+        }
+
+        /**
+         * Parses the solver profile from the solver section of the config, the tuned solver profile and the command
+         * line, in increasing precedence.
+         */
+        calibration::SolverProfile parseSolverProfile(const YAML::Node &config, const std::string &outputDir,
+                                                      const boost::program_options::variables_map &variables_map) {
+            auto profile = parseSolverProfile(config, calibration::SolverProfile());
+
+            std::string tunedProfileFile = (boost::filesystem::path(outputDir) / "solver.yaml").string();
+            if (variables_map.count("solver-profile") > 0) {
+                tunedProfileFile = variables_map["solver-profile"].as<std::string>();
+                if (!boost::filesystem::exists(tunedProfileFile)) {
+                    throw std::invalid_argument("Solver profile not found: " + tunedProfileFile);
+                }
+            }
+            if (boost::filesystem::exists(tunedProfileFile)) {
+                std::cout << "Loading the solver profile " << tunedProfileFile << std::endl;
+                profile = readSolverProfile(tunedProfileFile, profile);
+            }
+
+            if (variables_map.count("linear-solver") > 0) {
+                auto linearSolver = variables_map["linear-solver"].as<std::string>();
+                if (!ceres::StringToLinearSolverType(linearSolver, &profile.linearSolverType)) {
+                    throw std::invalid_argument("Unknown linear solver: " + linearSolver);
+                }
+            }
+            return profile;
+        }
+
+        void writeSolverProfile(const std::string &filename, const calibration::SolverProfile &solverProfile) {
+            YAML::Node node;
+            node["linear_solver"] = ceres::LinearSolverTypeToString(solverProfile.linearSolverType);
+            node["trust_region_strategy"] = ceres::TrustRegionStrategyTypeToString(
+                    solverProfile.trustRegionStrategyType);
+            node["use_nonmonotonic_steps"] = solverProfile.useNonmonotonicSteps;
+            node["max_iterations"] = solverProfile.maxNumIterations;
+            node["num_threads"] = solverProfile.numThreads;
+            node["residual_blocks_per_thread"] = solverProfile.residualBlocksPerThread;
+            node["function_tolerance"] = solverProfile.functionTolerance;
+            node["gradient_tolerance"] = solverProfile.gradientTolerance;
+            node["parameter_tolerance"] = solverProfile.parameterTolerance;
+
+            YAML::Node config;
+            config["solver"] = node;
+            std::ofstream file(filename);
+            file << config << std::endl;
+        }
+
         ParsedOptions parseCommandLine(int argc, const char **argv) {
             auto desc = createOptionsDescription();
 
@@ -117,7 +270,20 @@ namespace static_calibration {
                     getOrDefault(config, "max_pixel_distance_for_mapping", 1000),
                     getOrDefault(config, "max_matches_per_image_object", 5),
                     getOrDefault(config, "max_new_elements_per_mapping", -1),
-                    getOrDefault(config, "write_video", false)
+                    getOrDefault(config, "write_video", false),
+                    getOrDefault(config, "analytic_jacobians", true),
+                    getOrDefault(config, "parallel_starts", 1),
+                    getOrDefault(config, "max_threads", 0),
+                    getOrDefault(config, "seed", (std::uint64_t) 0),
+                    parseEarlyAbortOptions(config),
+                    parseOutlierRejectionOptions(config),
+                    getOrDefault(config, "estimate_covariance", true),
+                    parseSolverProfile(config, prefixFile(basepath, getOrThrow<std::string>(config, "output_dir")),
+                                       variables_map),
+                    variables_map.count("autotune") > 0,
+                    getOrDefault(config, "warm_start", false),
+                    parseCoarseToFineStages(config),
+                    variables_map.count("compare-coarse-to-fine") > 0
             };
 
             return parsedOptions;
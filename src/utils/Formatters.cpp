@@ -116,6 +116,28 @@ namespace static_calibration {
                 << YAML::Comment("Principal point Y [px]")
                 << 0 << 0 << YAML::Comment("Skew") << 1;
             out << YAML::EndSeq;
+
+            const auto &covariance = estimator.getPoseCovariance();
+            if (covariance.valid) {
+                auto intrinsicsDeviation = covariance.getIntrinsicsDeviation();
+                out << YAML::Key << "intrinsics_deviation/" + measurementPoint + "_" + cameraName;
+                out << YAML::BeginSeq;
+                out << intrinsicsDeviation[0] << YAML::Comment("Focal length X [px]")
+                    << intrinsicsDeviation[1] << YAML::Comment("Focal length Y [px]")
+                    << intrinsicsDeviation[2] << YAML::Comment("Principal point X [px]")
+                    << intrinsicsDeviation[3] << YAML::Comment("Principal point Y [px]");
+                out << YAML::EndSeq;
+
+                auto translationDeviation = covariance.getTranslationDeviation();
+                auto rotationDeviation = covariance.getRotationDeviation();
+                out << YAML::Key << "pose_deviation/" + measurementPoint + "_" + cameraName;
+                out << YAML::BeginSeq;
+                out << translationDeviation.x() << translationDeviation.y() << translationDeviation.z()
+                    << YAML::Comment("Translation [m]")
+                    << rotationDeviation.x() << rotationDeviation.y() << rotationDeviation.z()
+                    << YAML::Comment("Rotation [deg]");
+                out << YAML::EndSeq;
+            }
             out << YAML::EndMap;
 
             return out.c_str();
@@ -59,24 +59,23 @@ namespace static_calibration {
             renderText(finalFrame, ss);
         }
 
+        void render(const cv::Vec3d &color, const cv::Mat &image, const Eigen::Vector2d &pointInImageSpace);
+
         void render(cv::Mat &finalFrame, const std::string &id, const Eigen::Vector3d &object,
                     const Eigen::Vector3d &translation, const Eigen::Vector3d &rotation,
                     const std::vector<double> &intrinsics, const cv::Vec3d &color, bool showId) {
-            Eigen::Vector4d vectorInCameraSpace = static_calibration::camera::toCameraSpace(
-                    translation.data(), rotation.data(), object.data());
-
-            if (std::abs(vectorInCameraSpace.z()) > 1000) {
+            // A single point is projected in place, without the arrays of a batch.
+            double u, v, depth;
+            bool visible;
+            camera::projectPoints(translation.data(), rotation.data(), intrinsics.data(),
+                                  &object.x(), &object.y(), &object.z(), 1, &u, &v, &depth, &visible,
+                                  camera::Frustum(0, 1000, finalFrame.cols, finalFrame.rows));
+            if (!visible) {
                 return;
             }
 
-            bool flipped;
-            auto pixel = render(translation, rotation,
-                                intrinsics, object.homogeneous(), color,
-                                finalFrame, flipped);
-
-            if (flipped) {
-                return;
-            }
+            Eigen::Vector2d pixel{u, v};
+            render(color, finalFrame, pixel);
 
             std::stringstream ss;
             ss << std::fixed;
@@ -97,8 +96,6 @@ namespace static_calibration {
             return render(translation, rotation, intrinsics, vector, color, image, flipped);
         }
 
-        void render(const cv::Vec3d &color, const cv::Mat &image, const Eigen::Vector2d &pointInImageSpace);
-
         Eigen::Matrix<double, 2, 1> render(const Eigen::Vector3d &translation, const Eigen::Vector3d &rotation,
                                            const std::vector<double> &intrinsics,
                                            const Eigen::Vector4d &vector,
@@ -127,65 +124,68 @@ namespace static_calibration {
             );
         }
 
-        void render(cv::Mat &finalFrame, const static_calibration::calibration::WorldObject &worldObject,
-                    const Eigen::Vector3d &translation, const Eigen::Vector3d &rotation,
-                    const std::vector<double> &intrinsics, bool showIds, int maxRenderDistance, cv::Vec3d color) {
-            const auto &origin = worldObject.getOrigin();
-            const auto &endAxisA = worldObject.getEnd();
-
-            Eigen::Vector4d vectorInCameraSpace = static_calibration::camera::toCameraSpace(
-                    translation.data(), rotation.data(), origin.data());
-
-            if (vectorInCameraSpace.z() < 0 || vectorInCameraSpace.z() > maxRenderDistance) {
-                return;
+        /**
+         * Renders the given world objects onto the frame.<br>
+         * Projects the origins and ends of all objects in one single precision batch.
+         */
+        template<typename T>
+        void renderWorldObjects(cv::Mat &finalFrame, const std::vector<T> &objects,
+                                const Eigen::Vector3d &translation, const Eigen::Vector3d &rotation,
+                                const std::vector<double> &intrinsics, bool showIds, int maxRenderDistance,
+                                const cv::Vec3d &color) {
+            Eigen::Matrix<double, Eigen::Dynamic, 3> origins(objects.size(), 3), ends(objects.size(), 3);
+            for (int i = 0; i < objects.size(); i++) {
+                origins.row(i) = objects[i].getOrigin().transpose();
+                ends.row(i) = objects[i].getEnd().transpose();
             }
+            auto projectedOrigins = camera::projectPoints(translation.data(), rotation.data(), intrinsics.data(),
+                                                          camera::LocalPoints(origins),
+                                                          camera::Frustum(0, maxRenderDistance));
+            auto projectedEnds = camera::projectPoints(translation.data(), rotation.data(), intrinsics.data(),
+                                                       camera::LocalPoints(ends));
+
+            for (int i = 0; i < objects.size(); i++) {
+                if (!projectedOrigins.visible[i]) {
+                    continue;
+                }
 
-            bool flipped;
-            auto originPixel = render(translation, rotation,
-                                      intrinsics, origin.homogeneous(), color,
-                                      finalFrame, flipped);
-            if (flipped) {
-                return;
-            }
+                Eigen::Vector2d originPixel = projectedOrigins.getPixel(i);
+                render(color, finalFrame, originPixel);
+                if (!projectedEnds.visible[i]) {
+                    continue;
+                }
 
-            auto endPixel = render(translation, rotation,
-                                   intrinsics, endAxisA.homogeneous(), color,
-                                   finalFrame, flipped);
-            if (flipped) {
-                return;
-            }
+                Eigen::Vector2d endPixel = projectedEnds.getPixel(i);
+                render(color, finalFrame, endPixel);
 
-            std::stringstream ss;
-            ss << std::fixed;
-            ss << worldObject.getId();
-            //		ss << ": " << x << "," << y << "," << z;
+                std::stringstream ss;
+                ss << std::fixed;
+                ss << objects[i].getId();
+                //		ss << ": " << x << "," << y << "," << z;
 
-            if (showIds) {
-                renderLine(finalFrame, ss.str(), (int) originPixel.x(),
-                           (int) (finalFrame.rows - 1 - originPixel.y()), 0.5, {0, 1, 1});
-            }
+                if (showIds) {
+                    renderLine(finalFrame, ss.str(), (int) originPixel.x(),
+                               (int) (finalFrame.rows - 1 - originPixel.y()), 0.5, {0, 1, 1});
+                }
 
-            cv::line(finalFrame, cv::Point(originPixel.x(), finalFrame.rows - 1 - originPixel.y()),
-                     cv::Point(endPixel.x(), finalFrame.rows - 1 - endPixel.y()),
-                     color, 2);
+                cv::line(finalFrame, cv::Point(originPixel.x(), finalFrame.rows - 1 - originPixel.y()),
+                         cv::Point(endPixel.x(), finalFrame.rows - 1 - endPixel.y()),
+                         color, 2);
+            }
         }
 
         void render(cv::Mat &finalFrame, const std::vector<static_calibration::calibration::Object> &objects,
                     const Eigen::Vector3d &translation, const Eigen::Vector3d &rotation,
                     const std::vector<double> &intrinsics, bool showIds, int maxRenderDistance) {
-            cv::Vec3d color(0, 0, 1);
-            for (const auto &worldObject: objects) {
-                render(finalFrame, worldObject, translation, rotation, intrinsics, showIds, maxRenderDistance, color);
-            }
+            renderWorldObjects(finalFrame, objects, translation, rotation, intrinsics, showIds, maxRenderDistance,
+                               {0, 0, 1});
         }
 
         void render(cv::Mat &finalFrame, const std::vector<static_calibration::calibration::RoadMark> &objects,
                     const Eigen::Vector3d &translation, const Eigen::Vector3d &rotation,
                     const std::vector<double> &intrinsics, bool showIds, int maxRenderDistance) {
-            cv::Vec3d color(1, 1, 1);
-            for (const auto &worldObject: objects) {
-                render(finalFrame, worldObject, translation, rotation, intrinsics, showIds, maxRenderDistance, color);
-            }
+            renderWorldObjects(finalFrame, objects, translation, rotation, intrinsics, showIds, maxRenderDistance,
+                               {1, 1, 1});
         }
 
 
@@ -204,29 +204,35 @@ namespace static_calibration {
         void
         renderMapping(const cv::Mat &finalFrame, const objects::DataSet &dataSet, const Eigen::Vector3d &translation,
                       const Eigen::Vector3d &rotation, const std::vector<double> &intrinsics) {
+            std::vector<Eigen::Vector3d> worldObjectMids;
+            std::vector<int> imageObjectIndices;
             for (const auto &mapping: dataSet.getMergedMappings()) {
                 int worldObjectIndex = dataSet.get<calibration::Object>(mapping.first);
                 int roadMarkIndex = dataSet.get<calibration::RoadMark>(mapping.first);
 
-                calibration::WorldObject worldObject;
                 if (worldObjectIndex != -1) {
-                    worldObject = dataSet.get<calibration::Object>()[worldObjectIndex];
+                    worldObjectMids.emplace_back(dataSet.get<calibration::Object>()[worldObjectIndex].getMid());
                 } else if (roadMarkIndex != -1) {
-                    worldObject = dataSet.get<calibration::RoadMark>()[roadMarkIndex];
+                    worldObjectMids.emplace_back(dataSet.get<calibration::RoadMark>()[roadMarkIndex].getMid());
                 } else {
                     continue;
                 }
-                auto imageObject = dataSet.get<calibration::ImageObject>()[dataSet.get<calibration::ImageObject>(
-                        mapping.second)];
-
-                bool flipped;
-                Eigen::Vector2d pixel = camera::render(translation.data(), rotation.data(),
-                                                       intrinsics.data(),
-                                                       worldObject.getMid().data(),
-                                                       flipped);
-                if (flipped) {
+                imageObjectIndices.emplace_back(dataSet.get<calibration::ImageObject>(mapping.second));
+            }
+
+            Eigen::Matrix<double, Eigen::Dynamic, 3> mids(worldObjectMids.size(), 3);
+            for (int i = 0; i < worldObjectMids.size(); i++) {
+                mids.row(i) = worldObjectMids[i].transpose();
+            }
+            auto projectedMids = camera::projectPoints(translation.data(), rotation.data(), intrinsics.data(),
+                                                       camera::LocalPoints(mids));
+
+            for (int i = 0; i < projectedMids.size(); i++) {
+                if (!projectedMids.visible[i]) {
                     continue;
                 }
+                Eigen::Vector2d pixel = projectedMids.getPixel(i);
+                const auto &imageObject = dataSet.get<calibration::ImageObject>()[imageObjectIndices[i]];
                 auto centerLineSizeHalf = imageObject.getCenterLine().size() / 2;
                 cv::line(finalFrame, cv::Point(pixel.x(), finalFrame.rows - 1 - pixel.y()),
                          cv::Point(imageObject.getCenterLine()[centerLineSizeHalf].x(),
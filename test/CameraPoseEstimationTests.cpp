@@ -1,4 +1,5 @@
 #include "gtest/gtest.h"
+#include <algorithm>
 #include <iostream>
 #include <utility>
 #include <StaticCalibration/CameraPoseEstimation.hpp>
@@ -7,6 +8,8 @@
 #include "CameraTestBase.hpp"
 #include "StaticCalibration/CameraPoseEstimationWithIntrinsics.hpp"
 #include "StaticCalibration/camera/RenderingPipeline.hpp"
+#include "StaticCalibration/ThreadBudget.hpp"
+#include "StaticCalibration/utils/CommandLineParser.hpp"
 
 using namespace static_calibration::calibration;
 
@@ -115,6 +118,82 @@ namespace static_calibration {
 
                 dataSet.add(laneObject, laneImageObject);
             }
+
+            /**
+             * Inverts the dense normal equations J^T * J of all free parameter blocks of the problem of the estimator.
+             *
+             * @return The covariance, ordered by the pose, the free intrinsics and all other parameter blocks.
+             */
+            Eigen::MatrixXd calculateDenseCovariance() {
+                const ceres::Problem *problem = estimator->getProblem();
+                std::vector<double *> allBlocks;
+                problem->GetParameterBlocks(&allBlocks);
+                auto *pose = const_cast<double *>(estimator->getPose().data());
+                auto *cameraIntrinsics = const_cast<double *>(estimator->getIntrinsics().data());
+                std::vector<double *> blocks{pose};
+                if (problem->HasParameterBlock(cameraIntrinsics) &&
+                    !problem->IsParameterBlockConstant(cameraIntrinsics)) {
+                    blocks.emplace_back(cameraIntrinsics);
+                }
+                for (const auto &block: allBlocks) {
+                    if (block != pose && block != cameraIntrinsics && !problem->IsParameterBlockConstant(block)) {
+                        blocks.emplace_back(block);
+                    }
+                }
+                std::map<const double *, int> offsets;
+                int numParameters = 0;
+                for (const auto &block: blocks) {
+                    offsets[block] = numParameters;
+                    numParameters += problem->ParameterBlockLocalSize(block);
+                }
+
+                typedef Eigen::Matrix<double, Eigen::Dynamic, Eigen::Dynamic, Eigen::RowMajor> Jacobian;
+                Eigen::MatrixXd information = Eigen::MatrixXd::Zero(numParameters, numParameters);
+                std::vector<ceres::ResidualBlockId> residualBlocks;
+                problem->GetResidualBlocks(&residualBlocks);
+                for (const auto &residualBlock: residualBlocks) {
+                    std::vector<double *> parameterBlocks;
+                    problem->GetParameterBlocksForResidualBlock(residualBlock, &parameterBlocks);
+                    int numResiduals = problem->GetCostFunctionForResidualBlock(residualBlock)->num_residuals();
+                    std::vector<Jacobian> jacobians(parameterBlocks.size());
+                    std::vector<double *> jacobianPointers(parameterBlocks.size(), nullptr);
+                    for (int i = 0; i < parameterBlocks.size(); i++) {
+                        if (offsets.count(parameterBlocks[i]) > 0) {
+                            jacobians[i].resize(numResiduals, problem->ParameterBlockLocalSize(parameterBlocks[i]));
+                            jacobianPointers[i] = jacobians[i].data();
+                        }
+                    }
+                    std::vector<double> residuals(numResiduals);
+                    double cost;
+                    EXPECT_TRUE(problem->EvaluateResidualBlock(residualBlock, true, &cost, residuals.data(),
+                                                               jacobianPointers.data()));
+
+                    Eigen::MatrixXd jacobian = Eigen::MatrixXd::Zero(numResiduals, numParameters);
+                    for (int i = 0; i < parameterBlocks.size(); i++) {
+                        if (jacobianPointers[i] != nullptr) {
+                            jacobian.middleCols(offsets[parameterBlocks[i]], jacobians[i].cols()) = jacobians[i];
+                        }
+                    }
+                    information += jacobian.transpose() * jacobian;
+                }
+                return information.inverse();
+            }
+
+            /**
+             * Asserts that the covariance of the estimator matches the dense inverse of the normal equations.
+             */
+            void assertCovarianceMatchesDenseInverse(bool withIntrinsics) {
+                const auto &covariance = estimator->getPoseCovariance();
+                ASSERT_TRUE(covariance.valid);
+                auto denseCovariance = calculateDenseCovariance();
+                EXPECT_TRUE(covariance.pose.isApprox(denseCovariance.topLeftCorner<6, 6>(), 1e-4))
+                                    << covariance.pose << std::endl << std::endl << denseCovariance.topLeftCorner<6, 6>();
+                if (withIntrinsics) {
+                    EXPECT_TRUE(covariance.intrinsics.isApprox(denseCovariance.block<4, 4>(6, 6), 1e-4))
+                                        << covariance.intrinsics << std::endl << std::endl
+                                        << denseCovariance.block<4, 4>(6, 6);
+                }
+            }
         };
 
         /**
@@ -140,6 +219,24 @@ namespace static_calibration {
             EXPECT_LE(abs(estimator->getRotation().z()), 35);
         }
 
+        /**
+         * Tests that the random initial guesses are reproducible per job and independent between jobs.
+         */
+        TEST_F(CameraPoseEstimationTests, testSeededRandomNumbers) {
+            using static_calibration::calibration::deriveSeed;
+            EXPECT_EQ(deriveSeed(42, 3), deriveSeed(42, 3));
+            EXPECT_NE(deriveSeed(42, 3), deriveSeed(42, 4));
+            EXPECT_NE(deriveSeed(42, 3), deriveSeed(43, 3));
+
+            std::mt19937_64 randomEngine(deriveSeed(42, 3)), sameRandomEngine(deriveSeed(42, 3));
+            for (int i = 0; i < 100; i++) {
+                double value = static_calibration::calibration::generateRandomNumber(randomEngine, -35, 35);
+                EXPECT_EQ(value, static_calibration::calibration::generateRandomNumber(sameRandomEngine, -35, 35));
+                EXPECT_GE(value, -35);
+                EXPECT_LT(value, 35);
+            }
+        }
+
         /**
          * Tests that the optimization converges to the expected extrinsic parameters.
          */
@@ -150,6 +247,460 @@ namespace static_calibration {
         }
 
 
+        /**
+         * Tests that the optimization converges again when the estimator reuses its problem for a second estimation.
+         */
+        TEST_F(CameraPoseEstimationTests, testRepeatedEstimationReusesProblem) {
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+            addSomePointCorrespondences();
+            assertEstimation();
+            assertEstimation();
+        }
+
+        /**
+         * Tests that the optimization converges with the automatically differentiated correspondence residuals.
+         */
+        TEST_F(CameraPoseEstimationTests, testEstimationWithAutoDiff) {
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+            estimator->setAnalyticJacobians(false);
+            addSomePointCorrespondences();
+            assertEstimation();
+        }
+
+
+        /**
+         * Tests that the optimization converges with the Schur complement solvers that eliminate the lambdas first.
+         */
+        TEST_F(CameraPoseEstimationTests, testSchurEstimation) {
+            for (auto linearSolverType : {ceres::DENSE_SCHUR, ceres::SPARSE_SCHUR}) {
+                estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+                estimator->setLinearSolverType(linearSolverType);
+                addSomePointCorrespondences();
+                assertEstimation();
+                dataSet.clear();
+            }
+        }
+
+        /**
+         * Tests that all solver profiles reach the same cost and that the fastest of them is selected.
+         */
+        TEST_F(CameraPoseEstimationTests, testBenchmarkSolverProfiles) {
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+            addSomePointCorrespondences();
+            SolverProfile profile;
+            profile.maxNumIterations = 200;
+            estimator->setSolverProfile(profile);
+
+            auto candidates = getAutotuneCandidates(profile);
+            auto timings = estimator->benchmarkSolverProfiles(candidates, 1);
+            ASSERT_EQ(timings.size(), candidates.size());
+            EXPECT_EQ(estimator->getSolverProfile().maxNumIterations, 200);
+
+            std::vector<SolverProfileTiming> syntheticTimings{
+                    {candidates[0], 2, 1},
+                    {candidates[3], 1, 1 + 1e-9},
+                    {candidates[2], 0.5, 2},
+            };
+            const auto &fastest = selectFastestProfile(syntheticTimings);
+            EXPECT_EQ(fastest.seconds, 1);
+            EXPECT_EQ(fastest.profile.linearSolverType, ceres::DENSE_SCHUR);
+        }
+
+        /**
+         * Tests that a written solver profile is read back unchanged.
+         */
+        TEST_F(CameraPoseEstimationTests, testSolverProfileRoundTrip) {
+            SolverProfile profile;
+            profile.linearSolverType = ceres::DENSE_SCHUR;
+            profile.trustRegionStrategyType = ceres::DOGLEG;
+            profile.useNonmonotonicSteps = !profile.useNonmonotonicSteps;
+            profile.maxNumIterations = 123;
+            profile.numThreads = 3;
+            profile.residualBlocksPerThread = 17;
+            profile.functionTolerance = 1e-7;
+            profile.gradientTolerance = 1e-11;
+            profile.parameterTolerance = 1e-9;
+
+            std::string filename = testing::TempDir() + "solver.yaml";
+            static_calibration::utils::writeSolverProfile(filename, profile);
+            auto readProfile = static_calibration::utils::readSolverProfile(filename);
+
+            EXPECT_EQ(readProfile.linearSolverType, profile.linearSolverType);
+            EXPECT_EQ(readProfile.trustRegionStrategyType, profile.trustRegionStrategyType);
+            EXPECT_EQ(readProfile.useNonmonotonicSteps, profile.useNonmonotonicSteps);
+            EXPECT_EQ(readProfile.maxNumIterations, profile.maxNumIterations);
+            EXPECT_EQ(readProfile.numThreads, profile.numThreads);
+            EXPECT_EQ(readProfile.residualBlocksPerThread, profile.residualBlocksPerThread);
+            EXPECT_DOUBLE_EQ(readProfile.functionTolerance, profile.functionTolerance);
+            EXPECT_DOUBLE_EQ(readProfile.gradientTolerance, profile.gradientTolerance);
+            EXPECT_DOUBLE_EQ(readProfile.parameterTolerance, profile.parameterTolerance);
+            std::remove(filename.c_str());
+        }
+
+        /**
+         * Tests that an extended mapping converges in the first try when starting from the solution of its base mapping.
+         */
+        TEST_F(CameraPoseEstimationTests, testWarmStart) {
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+            addPost({-4, 20, 0}, "post_a");
+            addSomePointCorrespondences();
+            assertEstimation();
+
+            auto warmStart = estimator->getWarmStart();
+            EXPECT_EQ(warmStart.lambdas.size(), 8);
+            EXPECT_EQ(warmStart.lambdas.count({"post_a", "post_a"}), 1);
+
+            addPost({4, 40, 0}, "post_b");
+            estimator->setDataSet(dataSet);
+            estimator->setWarmStart(warmStart);
+            assertEstimation();
+            EXPECT_EQ(estimator->getSnapshot().tries, 1);
+        }
+
+        /**
+         * Tests that the optimization converges after adding and removing correspondences by the mapping extension.
+         */
+        TEST_F(CameraPoseEstimationTests, testMappingExtensionUpdatesProblem) {
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+            Eigen::Vector3d extensionPoint{3, 60, 2};
+            dataSet.add(Object("extension", extensionPoint, {0, 0, 0}, 0));
+            dataSet.add(ImageObject("extension", {getPixel(extensionPoint)}));
+            addSomePointCorrespondences();
+            assertEstimation();
+
+            const ceres::Problem *problem = estimator->getProblem();
+            ASSERT_NE(problem, nullptr);
+            std::vector<ceres::ResidualBlockId> baseBlocks;
+            problem->GetResidualBlocks(&baseBlocks);
+
+            estimator->setMappings(estimator->getDataSet().getMapping(), {{"extension", "extension"}});
+            estimator->setIntrinsics(intrinsics);
+            EXPECT_EQ(estimator->getDataSet().getParametricPoints<Object>().size(), 8);
+            ASSERT_EQ(estimator->getProblem(), problem);
+            std::vector<ceres::ResidualBlockId> extendedBlocks;
+            problem->GetResidualBlocks(&extendedBlocks);
+            EXPECT_GT(extendedBlocks.size(), baseBlocks.size());
+            for (const auto &block: baseBlocks) {
+                EXPECT_NE(std::find(extendedBlocks.begin(), extendedBlocks.end(), block), extendedBlocks.end());
+            }
+            assertEstimation();
+            ASSERT_EQ(estimator->getProblem(), problem);
+
+            estimator->setMappingExtension({});
+            EXPECT_EQ(estimator->getDataSet().getParametricPoints<Object>().size(), 7);
+            EXPECT_EQ(problem->NumResidualBlocks(), baseBlocks.size());
+            assertEstimation();
+            EXPECT_EQ(estimator->getProblem(), problem);
+        }
+
+        /**
+         * Tests that a wrong correspondence is dropped by the outlier rejection and does not bias the solution.
+         */
+        TEST_F(CameraPoseEstimationTests, testOutlierRejection) {
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+            Object wrongObject("wrong", {2, 25, 1}, {0, 0, 0}, 0);
+            dataSet.add(wrongObject, ImageObject("wrong", {getPixel(Eigen::Vector3d{-6, 45, 9})}));
+            addSomePointCorrespondences();
+            assertEstimation(1e-5);
+
+            auto weights = estimator->getWeights();
+            ASSERT_EQ(weights.size(), 8);
+            EXPECT_EQ(std::count(weights.begin(), weights.end(), 0.), 1);
+            EXPECT_EQ(std::count(weights.begin(), weights.end(), 1.), 7);
+
+            static_calibration::calibration::OutlierRejectionOptions options;
+            options.reweight = true;
+            estimator->setOutlierRejectionOptions(options);
+            estimator->estimate(log > 0);
+            EXPECT_TRUE(estimator->hasFoundValidSolution());
+            weights = estimator->getWeights();
+            EXPECT_LT(*std::min_element(weights.begin(), weights.end()), 0.5);
+        }
+
+        /**
+         * Tests that the covariance of the pose is calculated after the estimation and marginalizes the lambdas.
+         */
+        TEST_F(CameraPoseEstimationTests, testPoseCovariance) {
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+            addPost({-4, 20, 0}, "post_a");
+            addSomePointCorrespondences();
+            assertEstimation(1e-5);
+
+            auto covariance = estimator->getPoseCovariance();
+            ASSERT_TRUE(covariance.valid);
+            EXPECT_TRUE(covariance.pose.isApprox(covariance.pose.transpose()));
+            for (int i = 0; i < 6; i++) {
+                EXPECT_GT(covariance.pose(i, i), 0);
+            }
+            EXPECT_EQ(covariance.intrinsics, Eigen::Matrix4d::Zero());
+            EXPECT_GT(covariance.getTranslationDeviation().minCoeff(), 0);
+            EXPECT_GT(covariance.getRotationDeviation().minCoeff(), 0);
+            assertCovarianceMatchesDenseInverse(false);
+
+            estimator->setCovarianceEnabled(false);
+            estimator->estimate(log > 0);
+            EXPECT_TRUE(estimator->hasFoundValidSolution());
+            EXPECT_FALSE(estimator->getPoseCovariance().valid);
+        }
+
+        /**
+         * Tests that the covariance of the pose and the intrinsics matches the dense inverse of the normal equations.
+         */
+        TEST_F(CameraPoseEstimationTests, testPoseAndIntrinsicsCovariance) {
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimationWithIntrinsics>(
+                    intrinsics);
+            addPost({15, 4, 8}, "a");
+            addPost({-2, 17, 0}, "b");
+            addLane({-10, 0, 0}, {-10, 10, 0}, "c");
+            estimator->setDataSet(dataSet);
+            estimator->estimate(log > 0);
+            ASSERT_TRUE(estimator->hasFoundValidSolution());
+
+            assertCovarianceMatchesDenseInverse(true);
+            EXPECT_GT(estimator->getPoseCovariance().intrinsics.diagonal().minCoeff(), 0);
+        }
+
+        /**
+         * Tests that the jobs of a batch estimation converge without touching the state of the estimator.
+         */
+        TEST_F(CameraPoseEstimationTests, testEstimateBatch) {
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+            Eigen::Vector3d extensionPoint{3, 60, 2};
+            dataSet.add(Object("extension", extensionPoint, {0, 0, 0}, 0));
+            dataSet.add(ImageObject("extension", {getPixel(extensionPoint)}));
+            addSomePointCorrespondences();
+            const Eigen::Vector3d initialTranslation = estimator->getTranslation();
+
+            static_calibration::calibration::BatchJob job;
+            job.mapping = dataSet.getMapping();
+            job.translation = translation + Eigen::Vector3d{1, -1, 2};
+            job.rotation = rotation + Eigen::Vector3d{2, 0, -2};
+            std::vector<static_calibration::calibration::BatchJob> jobs{job, job, job};
+            jobs[1].mappingExtension = {{"extension", "extension"}};
+
+            auto results = estimator->estimateBatch(dataSet, jobs, 2);
+            ASSERT_EQ(results.size(), jobs.size());
+            for (const auto &result: results) {
+                EXPECT_TRUE(result.validSolution);
+                assertVectorsNearEqual(result.translation, translation, 1e-5);
+                assertVectorsNearEqual(result.rotation, rotation, 1e-5);
+                EXPECT_GE(result.seconds, 0);
+            }
+            assertVectorsNearEqual(estimator->getTranslation(), initialTranslation);
+            EXPECT_TRUE(estimator->getDataSet().getMappingExtension().empty());
+            EXPECT_EQ(dataSet.getParametricPoints<Object>().size(), 7);
+        }
+
+        /**
+         * Tests that the optimization converges when starting from the solutions of subsampled coarse stages.
+         */
+        TEST_F(CameraPoseEstimationTests, testCoarseToFineEstimation) {
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+            estimator->setCoarseToFineStages({{4, 0}, {1, 2}});
+            addPost({-4, 20, 0}, "post_a");
+            addPost({4, 40, 0}, "post_b");
+            addSomePointCorrespondences();
+            assertEstimation();
+            EXPECT_EQ(estimator->getDataSet().getParametricPoints<Object>().size(), 17);
+        }
+
+        /**
+         * Tests that the optimization converges to the expected extrinsic parameters when running parallel tries.
+         */
+        TEST_F(CameraPoseEstimationTests, testParallelEstimation) {
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+            estimator->setParallelStarts(4);
+            addSomePointCorrespondences();
+            assertEstimation();
+            EXPECT_TRUE(estimator->hasFoundValidSolution());
+        }
+
+        /**
+         * Tests that the first valid try stops the solves of the other parallel tries before they converge.
+         */
+        TEST_F(CameraPoseEstimationTests, testParallelEstimationStopsOtherTries) {
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+            addSomePointCorrespondences();
+            assertEstimation();
+
+            // The first try starts at the solution, the other tries only end by convergence of the trust region.
+            SolverProfile profile;
+            profile.maxNumIterations = 100000;
+            profile.functionTolerance = 0;
+            profile.gradientTolerance = 0;
+            profile.parameterTolerance = 0;
+            estimator->setSolverProfile(profile);
+            estimator->setWarmStart(estimator->getWarmStart());
+            estimator->setParallelStarts(4);
+            assertEstimation();
+
+            auto snapshot = estimator->getSnapshot();
+            EXPECT_EQ(snapshot.tries, 4);
+            EXPECT_GE(snapshot.stoppedTries, 1);
+        }
+
+        /**
+         * Tests that parallel estimations with the same seed end in the same solution bit for bit.
+         */
+        TEST_F(CameraPoseEstimationTests, testParallelEstimationIsReproducible) {
+            std::vector<Eigen::Matrix<double, 6, 1>> poses;
+            std::vector<int> tries;
+            for (int run = 0; run < 2; run++) {
+                estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+                addSomePointCorrespondences();
+                estimator->setParallelStarts(4);
+                estimator->setSeed(7);
+                SolverProfile profile;
+                profile.numThreads = 1;
+                estimator->setSolverProfile(profile);
+                EarlyAbortOptions options;
+                options.minIterations = 3;
+                options.maxRatioToBestCost = 10;
+                estimator->setEarlyAbortOptions(options);
+                estimator->estimate(log > 0);
+                ASSERT_TRUE(estimator->hasFoundValidSolution());
+                poses.emplace_back(estimator->getPose());
+                tries.emplace_back(estimator->getSnapshot().tries);
+            }
+            EXPECT_EQ(poses[0], poses[1]);
+            EXPECT_EQ(tries[0], tries[1]);
+            EXPECT_EQ(tries[0] % 4, 0);
+        }
+
+        /**
+         * Tests that the asynchronous estimation publishes its result in the snapshot.
+         */
+        TEST_F(CameraPoseEstimationTests, testAsyncEstimationSnapshot) {
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+            addSomePointCorrespondences();
+            auto estimation = estimator->estimateAsync();
+            estimation.wait();
+
+            EXPECT_TRUE(estimator->isEstimationFinished());
+            EXPECT_FALSE(estimator->isCancelled());
+            auto snapshot = estimator->getSnapshot();
+            EXPECT_GE(snapshot.tries, 1);
+            assertVectorsNearEqual(snapshot.translation, translation, 1e-8);
+            assertVectorsNearEqual(snapshot.rotation, rotation, 1e-8);
+        }
+
+        /**
+         * Tests that a cancelled estimation finishes and that the next estimation is not cancelled.
+         */
+        TEST_F(CameraPoseEstimationTests, testCancelEstimation) {
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+            addSomePointCorrespondences();
+            auto estimation = estimator->estimateAsync();
+            estimator->cancel();
+            estimation.wait();
+
+            EXPECT_TRUE(estimator->isEstimationFinished());
+            EXPECT_TRUE(estimator->isCancelled());
+
+            assertEstimation();
+            EXPECT_FALSE(estimator->isCancelled());
+        }
+
+
+        /**
+         * Tests that the early abort callback aborts hopeless solves and terminates stalled solves.
+         */
+        TEST_F(CameraPoseEstimationTests, testEarlyAbortCallback) {
+            auto runSolve = [](const EarlyAbortOptions &options, double bestCost, const std::vector<double> &costs,
+                               bool &aborted) {
+                std::atomic<double> sharedBestCost{bestCost};
+                EarlyAbortCallback callback(options, sharedBestCost);
+                ceres::CallbackReturnType result = ceres::SOLVER_CONTINUE;
+                ceres::IterationSummary summary;
+                for (int i = 0; i < costs.size() && result == ceres::SOLVER_CONTINUE; i++) {
+                    summary.iteration = i;
+                    summary.cost = costs[i];
+                    result = callback(summary);
+                }
+                aborted = callback.hasAborted();
+                return result;
+            };
+            std::vector<double> costs{100, 50, 40, 39.99, 39.98, 39.97};
+            bool aborted;
+
+            EarlyAbortOptions options;
+            EXPECT_EQ(runSolve(options, 1, costs, aborted), ceres::SOLVER_CONTINUE);
+            EXPECT_FALSE(aborted);
+
+            options.minIterations = 2;
+            options.maxCost = 30;
+            EXPECT_EQ(runSolve(options, 1, costs, aborted), ceres::SOLVER_ABORT);
+            EXPECT_TRUE(aborted);
+
+            options.maxCost = std::numeric_limits<double>::infinity();
+            options.maxRatioToBestCost = 10;
+            EXPECT_EQ(runSolve(options, 1, costs, aborted), ceres::SOLVER_ABORT);
+            EXPECT_TRUE(aborted);
+            EXPECT_EQ(runSolve(options, 10, costs, aborted), ceres::SOLVER_CONTINUE);
+            EXPECT_FALSE(aborted);
+
+            options.stallIterations = 2;
+            EXPECT_EQ(runSolve(options, 10, costs, aborted), ceres::SOLVER_TERMINATE_SUCCESSFULLY);
+            EXPECT_FALSE(aborted);
+        }
+
+        /**
+         * Tests that the early abort cuts the tries of an estimation short and that they publish their costs.
+         */
+        TEST_F(CameraPoseEstimationTests, testEarlyAbortEstimation) {
+            std::atomic<double> bestCost{std::numeric_limits<double>::infinity()};
+            EarlyAbortCallback callback(EarlyAbortOptions(), bestCost);
+            ceres::IterationSummary summary;
+            summary.cost = 42;
+            callback(summary);
+            EXPECT_EQ(bestCost, 42);
+
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimation>(intrinsics);
+            addSomePointCorrespondences();
+            EarlyAbortOptions options;
+            options.minIterations = 1;
+            options.maxCost = 0;
+            estimator->setEarlyAbortOptions(options);
+            estimator->estimate(log > 0);
+
+            // Every try is aborted after its first iteration, hence the next try starts.
+            EXPECT_FALSE(estimator->hasFoundValidSolution());
+            EXPECT_GT(estimator->getSnapshot().tries, 1);
+        }
+
+
+        /**
+         * Tests that the single pass residual evaluation is consistent with the losses of the residual groups.
+         */
+        TEST_F(CameraPoseEstimationTests, testResidualEvaluation) {
+            estimator = std::make_shared<static_calibration::calibration::CameraPoseEstimationWithIntrinsics>(
+                    intrinsics);
+            addPost({15, 4, 8}, "a");
+            addPost({-2, 17, 0}, "b");
+            addLane({-10, 0, 0}, {-10, 10, 0}, "c");
+            estimator->setDataSet(dataSet);
+            estimator->estimate(log > 0);
+
+            const auto &evaluation = estimator->getResidualEvaluation();
+            ASSERT_GT(evaluation.size(), 0);
+            ASSERT_EQ(evaluation.blockCosts.size(), evaluation.size());
+            ASSERT_EQ(evaluation.residualOffsets.size(), evaluation.size() + 1);
+            EXPECT_EQ(evaluation.residualOffsets.back(), evaluation.residuals.size());
+
+            double totalCost = 0;
+            for (int i = 0; i < evaluation.size(); i++) {
+                EXPECT_LE(evaluation.residualOffsets[i], evaluation.residualOffsets[i + 1]);
+                EXPECT_GE(evaluation.blockCosts[i], 0);
+                totalCost += evaluation.blockCosts[i];
+            }
+            EXPECT_NEAR(totalCost, estimator->getTotalLoss(), 1e-9 * (1 + totalCost));
+            EXPECT_NEAR(estimator->getTotalLoss(),
+                        estimator->getCorrespondencesLoss() + estimator->getExplicitRoadMarksLoss() +
+                        estimator->getLambdasLoss() + estimator->getRotationsLoss() +
+                        estimator->getIntrinsicsLoss(), 1e-9 * (1 + totalCost));
+        }
+
+
         /**
          * Tests that the rotational parameters are in the interval [-180, 180]
          */
@@ -184,5 +735,41 @@ namespace static_calibration {
             estimator->setDataSet(dataSet);
             assertEstimation(1e-5);
         }
+
+        /**
+         * Tests that the thread budget caps the leases and takes back the threads of destroyed leases.
+         */
+        TEST_F(CameraPoseEstimationTests, testThreadBudget) {
+            auto &budget = static_calibration::calibration::ThreadBudget::getInstance();
+            int originalMaxThreads = budget.getMaxThreads();
+            budget.setMaxThreads(4);
+            EXPECT_EQ(budget.getThreadsPerJob(1), 4);
+            EXPECT_EQ(budget.getThreadsPerJob(3), 1);
+            EXPECT_EQ(budget.getThreadsPerJob(8), 1);
+            ASSERT_NE(budget.getContext(), nullptr);
+
+            {
+                auto wide = budget.acquire(3);
+                EXPECT_EQ(wide.getThreads(), 3);
+                auto remainder = budget.acquire(3);
+                EXPECT_EQ(remainder.getThreads(), 1);
+            }
+            EXPECT_EQ(budget.acquire(10).getThreads(), 4);
+
+            static_calibration::calibration::SolverProfile profile;
+            profile.residualBlocksPerThread = 100;
+            EXPECT_EQ(profile.getRequestedThreads(50), 1);
+            EXPECT_EQ(profile.getRequestedThreads(250), 3);
+            profile.numThreads = 2;
+            EXPECT_EQ(profile.getRequestedThreads(250), 2);
+
+            addPost({15, 4, 8}, "a");
+            addPost({-2, 17, 0}, "b");
+            addLane({-10, 0, 0}, {-10, 10, 0}, "c");
+            estimator->setParallelStarts(4);
+            estimator->setDataSet(dataSet);
+            assertEstimation(1e-5);
+            budget.setMaxThreads(originalMaxThreads);
+        }
     }// namespace toCameraSpace
 }// namespace static_calibration
\ No newline at end of file
@@ -4,8 +4,39 @@
 
 #include "CameraTestBase.hpp"
 
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+	/**
+	 * The number of calls to the global operator new.
+	 */
+	std::atomic<long> numberOfAllocations{0};
+}
+
+void *operator new(std::size_t size) {
+	numberOfAllocations++;
+	if (void *pointer = std::malloc(size == 0 ? 1 : size)) {
+		return pointer;
+	}
+	throw std::bad_alloc();
+}
+
+void operator delete(void *pointer) noexcept {
+	std::free(pointer);
+}
+
+void operator delete(void *pointer, std::size_t) noexcept {
+	std::free(pointer);
+}
+
 namespace static_calibration {
 	namespace tests {
+
+		long getNumberOfAllocations() {
+			return numberOfAllocations.load();
+		}
 		void
 		assertVectorsNearEqual(const Eigen::VectorXd &a, const Eigen::VectorXd &b,
 							   double maxDifference) {
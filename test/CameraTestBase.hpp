@@ -35,6 +35,11 @@ namespace static_calibration {
 		void assertVectorsNearEqual(const Eigen::Vector2d &a, double x, double y,
 									double maxDifference = 1e-4);
 
+		/**
+		 * @get The number of calls to the global operator new since the start of the test binary.
+		 */
+		long getNumberOfAllocations();
+
 		/**
 		 * Base for tests that need camera parameters.
 		 */
@@ -144,6 +144,60 @@ namespace static_calibration {
         }
 
 
+        /**
+         * Tests that the subsampled dataset keeps every k-th row of the center lines and at most the maximal number of
+         * points per mapping entry.
+         */
+        TEST_F(DataSetTests, testSubsample) {
+            objects::DataSet dataset;
+            ImageObject imageObject("post");
+            for (int i = 0; i < 10; i++) {
+                imageObject.addPixel({100, 100 + i});
+            }
+            dataset.add(Object("post", {0, 10, 0}, {0, 0, 1}, 2), imageObject);
+            ASSERT_EQ(dataset.getParametricPoints<Object>().size(), 10);
+
+            auto subsampled = dataset.subsample(3, 0);
+            ASSERT_EQ(subsampled.getParametricPoints<Object>().size(), 4);
+            assertVectorEqual(subsampled.getParametricPoints<Object>()[1].getExpectedPixel(), 100, 103);
+            EXPECT_NE(subsampled.getParametricPoints<Object>()[0].getLambda(),
+                      dataset.getParametricPoints<Object>()[0].getLambda());
+
+            subsampled = dataset.subsample(1, 2);
+            ASSERT_EQ(subsampled.getParametricPoints<Object>().size(), 2);
+            ASSERT_EQ(dataset.getParametricPoints<Object>().size(), 10);
+        }
+
+        /**
+         * Tests that changing the mapping extension only adds and removes the parametric points of the changed entries.
+         */
+        TEST_F(DataSetTests, testSetMappingExtension) {
+            auto dataset = createMockDataSetForMapping();
+            dataset.setMapping({{"a", "b"}});
+            ASSERT_EQ(dataset.getParametricPoints<RoadMark>().size(), 1);
+            const double *baseLambda = dataset.getParametricPoints<RoadMark>()[0].getLambda();
+
+            auto removedLambdas = dataset.setMappingExtension({{"0", "1"}});
+            EXPECT_TRUE(removedLambdas.empty());
+            ASSERT_EQ(dataset.getParametricPoints<RoadMark>().size(), 2);
+            ASSERT_EQ(dataset.getParametricPointGroups<RoadMark>().size(), 2);
+            EXPECT_EQ(dataset.getParametricPoints<RoadMark>()[0].getLambda(), baseLambda);
+            EXPECT_EQ(dataset.getLambdas().count({"0", "1"}), 1);
+
+            removedLambdas = dataset.setMappingExtension({{"0", "2"}});
+            EXPECT_EQ(removedLambdas.size(), 1);
+            ASSERT_EQ(dataset.getParametricPoints<RoadMark>().size(), 2);
+            EXPECT_EQ(dataset.getParametricPoints<RoadMark>()[0].getLambda(), baseLambda);
+            EXPECT_EQ(dataset.getLambdas().count({"0", "1"}), 0);
+            EXPECT_EQ(dataset.getLambdas().count({"0", "2"}), 1);
+
+            removedLambdas = dataset.setMappingExtension({});
+            EXPECT_EQ(removedLambdas.size(), 1);
+            ASSERT_EQ(dataset.getParametricPoints<RoadMark>().size(), 1);
+            ASSERT_EQ(dataset.getParametricPointGroups<RoadMark>().size(), 1);
+            EXPECT_EQ(dataset.getParametricPoints<RoadMark>()[0].getLambda(), baseLambda);
+        }
+
         /**
          * Tests loading the image objects from a YAML file.
          */
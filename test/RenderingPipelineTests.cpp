@@ -6,10 +6,50 @@
 #include "CameraTestBase.hpp"
 
 #include "StaticCalibration/camera/RenderingPipeline.hpp"
+#include "ceres/ceres.h"
 
 namespace static_calibration {
     namespace tests {
 
+        /**
+         * @get The scalar part of the given value.
+         */
+        double getScalar(double value) {
+            return value;
+        }
+
+        /**
+         * @overload
+         */
+        template<int N>
+        double getScalar(const ceres::Jet<double, N> &value) {
+            return value.a;
+        }
+
+        /**
+         * Renders the given world position with the parameters converted to T and returns the number of heap
+         * allocations that happened during rendering.
+         */
+        template<typename T>
+        long countRenderAllocations(const Eigen::Vector3d &translation, const Eigen::Vector3d &rotation,
+                                    const std::vector<double> &intrinsics, const Eigen::Vector3d &worldPosition,
+                                    Eigen::Vector2d &pixel) {
+            const T translationT[3] = {(T) translation.x(), (T) translation.y(), (T) translation.z()};
+            const T rotationT[3] = {(T) rotation.x(), (T) rotation.y(), (T) rotation.z()};
+            const T intrinsicsT[5] = {(T) intrinsics[0], (T) intrinsics[1], (T) intrinsics[2], (T) intrinsics[3],
+                                      (T) 0};
+            const T worldPositionT[3] = {(T) worldPosition.x(), (T) worldPosition.y(), (T) worldPosition.z()};
+
+            bool flipped;
+            long allocationsBefore = getNumberOfAllocations();
+            Eigen::Matrix<T, 2, 1> result = static_calibration::camera::render(translationT, rotationT, intrinsicsT,
+                                                                               worldPositionT, flipped);
+            long allocationsAfter = getNumberOfAllocations();
+
+            pixel << getScalar(result.x()), getScalar(result.y());
+            return allocationsAfter - allocationsBefore;
+        }
+
         /**
          * Asserts that the camera rotation matrix is built up by the given right, up and forward vectors.
          */
@@ -126,6 +166,43 @@ namespace static_calibration {
             assertVectorsNearEqual(pointInCameraSpace, -10, -15, 0);
         }
 
+        /**
+         * Tests that the closed form world to camera transformation matches inverting the concatenated homogeneous
+         * axis rotations.
+         */
+        TEST_F(RenderingPipelineTests, testWorldToCameraTransformationMatchesInverse) {
+            Eigen::Vector4d pointInWorldSpace{4, 20, 5, 1};
+            Eigen::Matrix4d zFlip = Eigen::Vector4d(1, 1, -1, 1).asDiagonal();
+
+            for (int x = -180; x <= 180; x += 45) {
+                for (int y = -180; y <= 180; y += 45) {
+                    for (int z = -180; z <= 180; z += 45) {
+                        Eigen::Vector3d eulerAngles{(double) x, (double) y, (double) z};
+                        Eigen::Matrix4d expectedRotation = Eigen::Matrix4d::Identity();
+                        expectedRotation.block<3, 3>(0, 0) = (
+                                Eigen::AngleAxisd(z * M_PI / 180, Eigen::Vector3d::UnitZ()) *
+                                Eigen::AngleAxisd(-y * M_PI / 180, Eigen::Vector3d::UnitY()) *
+                                Eigen::AngleAxisd(-x * M_PI / 180, Eigen::Vector3d::UnitX())
+                        ).toRotationMatrix();
+                        expectedRotation = zFlip * expectedRotation;
+
+                        Eigen::Vector4d expected = expectedRotation.inverse() *
+                                                   Eigen::Vector4d(pointInWorldSpace.x() - translation.x(),
+                                                                   pointInWorldSpace.y() - translation.y(),
+                                                                   pointInWorldSpace.z() - translation.z(), 1);
+
+                        Eigen::Matrix4d rotationMatrix = static_calibration::camera::getCameraRotationMatrix(
+                                eulerAngles.data());
+                        EXPECT_LT((rotationMatrix - expectedRotation).cwiseAbs().maxCoeff(), 1e-9);
+                        assertVectorsNearEqual(
+                                static_calibration::camera::toCameraSpace(translation.data(), eulerAngles.data(),
+                                                                          pointInWorldSpace.data()),
+                                expected, 1e-9);
+                    }
+                }
+            }
+        }
+
         /**
          * Tests that rendering points in world coordinates results in correct pixels in an image.
          */
@@ -186,6 +263,168 @@ namespace static_calibration {
 
         }
 
+        /**
+         * Tests that the rendering pipeline does not allocate heap memory for plain and automatically
+         * differentiated scalars.
+         */
+        TEST_F(RenderingPipelineTests, testRenderDoesNotAllocate) {
+            Eigen::Vector3d worldPosition{4, 20, 5};
+            Eigen::Vector2d expectedPixel = static_calibration::camera::render(
+                    translation.data(), rotation.data(), intrinsics.data(), worldPosition.data());
+            Eigen::Vector2d pixel;
+
+            EXPECT_EQ(countRenderAllocations<double>(translation, rotation, intrinsics, worldPosition, pixel), 0);
+            assertVectorsNearEqual(pixel, expectedPixel.x(), expectedPixel.y());
+
+            typedef ceres::Jet<double, 8> Jet8;
+            EXPECT_EQ(countRenderAllocations<Jet8>(translation, rotation, intrinsics, worldPosition, pixel), 0);
+            assertVectorsNearEqual(pixel, expectedPixel.x(), expectedPixel.y());
+
+            typedef ceres::Jet<double, 12> Jet12;
+            EXPECT_EQ(countRenderAllocations<Jet12>(translation, rotation, intrinsics, worldPosition, pixel), 0);
+            assertVectorsNearEqual(pixel, expectedPixel.x(), expectedPixel.y());
+        }
+
+        /**
+         * Tests that the rendering pipeline can be instantiated for scalar types other than double, Jet<double, 8>
+         * and Jet<double, 12>.
+         */
+        TEST_F(RenderingPipelineTests, testRenderWithOtherScalarTypes) {
+            Eigen::Vector3d worldPosition{4, 20, 5};
+            Eigen::Vector2d expectedPixel = static_calibration::camera::render(
+                    translation.data(), rotation.data(), intrinsics.data(), worldPosition.data());
+            Eigen::Vector2d pixel;
+
+            typedef ceres::Jet<double, 3> Jet3;
+            EXPECT_EQ(countRenderAllocations<Jet3>(translation, rotation, intrinsics, worldPosition, pixel), 0);
+            assertVectorsNearEqual(pixel, expectedPixel.x(), expectedPixel.y());
+
+            typedef ceres::Jet<double, 17> Jet17;
+            EXPECT_EQ(countRenderAllocations<Jet17>(translation, rotation, intrinsics, worldPosition, pixel), 0);
+            assertVectorsNearEqual(pixel, expectedPixel.x(), expectedPixel.y());
+        }
+
+        /**
+         * Tests that projecting a batch of points results in the same pixels, depths and visibility flags as
+         * rendering every point on its own.
+         */
+        TEST_F(RenderingPipelineTests, testProjectPoints) {
+            Eigen::Matrix<double, Eigen::Dynamic, 3> points(100, 3);
+            for (int i = 0; i < points.rows(); i++) {
+                points.row(i) << (i % 10) * 3 - 15, (i / 10) * 7 - 30, (i % 7) - 3;
+            }
+
+            auto projectedPoints = static_calibration::camera::projectPoints(translation.data(), rotation.data(),
+                                                                             intrinsics.data(), points);
+            ASSERT_EQ(projectedPoints.size(), points.rows());
+
+            for (int i = 0; i < points.rows(); i++) {
+                Eigen::Vector3d point = points.row(i).transpose();
+                bool flipped;
+                Eigen::Vector2d pixel = static_calibration::camera::render(translation.data(), rotation.data(),
+                                                                           intrinsics.data(), point.data(),
+                                                                           flipped);
+                Eigen::Vector4d pointInCameraSpace = static_calibration::camera::toCameraSpace(
+                        translation.data(), rotation.data(), point.data());
+
+                assertVectorsNearEqual(projectedPoints.getPixel(i), pixel.x(), pixel.y(), 1e-6);
+                EXPECT_NEAR(projectedPoints.depth[i], pointInCameraSpace.z(), 1e-9);
+                EXPECT_EQ(projectedPoints.visible[i], !flipped);
+            }
+        }
+
+        /**
+         * Tests that projecting a batch of points culls the points outside of the near and far plane and outside of
+         * the image.
+         */
+        TEST_F(RenderingPipelineTests, testProjectPointsFrustum) {
+            Eigen::Matrix<double, Eigen::Dynamic, 3> points(100, 3);
+            for (int i = 0; i < points.rows(); i++) {
+                points.row(i) << (i % 10) * 30 - 150, (i / 10) * 70 - 300, (i % 7) - 3;
+            }
+            static_calibration::camera::Frustum frustum(20, 200, 1920, 1200);
+
+            auto projectedPoints = static_calibration::camera::projectPoints(translation.data(), rotation.data(),
+                                                                             intrinsics.data(), points);
+            auto culledPoints = static_calibration::camera::projectPoints(translation.data(), rotation.data(),
+                                                                          intrinsics.data(), points, frustum);
+
+            int numberOfVisiblePoints = 0;
+            for (int i = 0; i < points.rows(); i++) {
+                Eigen::Vector2d pixel = projectedPoints.getPixel(i);
+                bool expectedVisible = projectedPoints.depth[i] >= 20 && projectedPoints.depth[i] <= 200 &&
+                                       pixel.x() >= 0 && pixel.x() < 1920 && pixel.y() >= 0 && pixel.y() < 1200;
+                EXPECT_EQ(culledPoints.visible[i], expectedVisible);
+                EXPECT_EQ(culledPoints.depth[i], projectedPoints.depth[i]);
+                assertVectorsNearEqual(culledPoints.getPixel(i), pixel.x(), pixel.y(), 1e-9);
+                numberOfVisiblePoints += expectedVisible;
+            }
+            EXPECT_GT(numberOfVisiblePoints, 0);
+            EXPECT_LT(numberOfVisiblePoints, points.rows());
+        }
+
+        /**
+         * Tests that the single precision batch projection of points far away from the world origin results in the
+         * same pixels as the double precision projection up to a fraction of a pixel.
+         */
+        TEST_F(RenderingPipelineTests, testProjectPointsSinglePrecision) {
+            Eigen::Vector3d offset{812.3, -795.7, 4.2};
+            Eigen::Vector3d farTranslation = translation + offset;
+            Eigen::Matrix<double, Eigen::Dynamic, 3> points(100, 3);
+            for (int i = 0; i < points.rows(); i++) {
+                points.row(i) << (i % 10) * 3 - 15, (i / 10) * 7 - 30, (i % 7) - 3;
+                points.row(i) += offset.transpose();
+            }
+
+            auto projectedPoints = static_calibration::camera::projectPoints(farTranslation.data(), rotation.data(),
+                                                                             intrinsics.data(), points);
+            auto projectedPointsf = static_calibration::camera::projectPoints(
+                    farTranslation.data(), rotation.data(), intrinsics.data(),
+                    static_calibration::camera::LocalPoints(points));
+            ASSERT_EQ(projectedPointsf.size(), points.rows());
+
+            for (int i = 0; i < points.rows(); i++) {
+                if (!projectedPoints.visible[i]) {
+                    continue;
+                }
+                Eigen::Vector2d pixel = projectedPoints.getPixel(i);
+                assertVectorsNearEqual(projectedPointsf.getPixel(i), pixel.x(), pixel.y(), 1e-2);
+                EXPECT_NEAR(projectedPointsf.depth[i], projectedPoints.depth[i], 1e-3);
+                EXPECT_EQ(projectedPointsf.visible[i], projectedPoints.visible[i]);
+            }
+        }
+
+        /**
+         * Tests that the angle axis pose results in the same rotation and pixels as the euler angle rotation and that
+         * the euler angles are recovered from the pose.
+         */
+        TEST_F(RenderingPipelineTests, testRenderPose) {
+            std::vector<Eigen::Vector3d> rotations{{90, 0, 0}, {85, 3, -7}, {100, 10, 20}, {0, 0, 0}, {60, -20, 170}};
+            Eigen::Vector3d worldPosition{4, 20, 5};
+
+            for (const auto &eulerAngles: rotations) {
+                Eigen::Matrix<double, 6, 1> pose = static_calibration::camera::getPose(translation.data(),
+                                                                                       eulerAngles.data());
+                assertVectorsNearEqual(pose.head<3>(), translation);
+                assertVectorsNearEqual(static_calibration::camera::getEulerAnglesFromAngleAxis(pose.data() + 3),
+                                       eulerAngles, 1e-9);
+
+                Eigen::Matrix3d expectedRotation = static_calibration::camera::getCameraRotation(eulerAngles.data());
+                Eigen::Matrix3d actualRotation = static_calibration::camera::getCameraRotationFromAngleAxis(
+                        pose.data() + 3);
+                EXPECT_TRUE(actualRotation.isApprox(expectedRotation, 1e-12));
+
+                bool expectedFlipped, actualFlipped;
+                Eigen::Vector2d expectedPixel = static_calibration::camera::render(
+                        translation.data(), eulerAngles.data(), intrinsics.data(), worldPosition.data(),
+                        expectedFlipped);
+                Eigen::Vector2d actualPixel = static_calibration::camera::renderPose(
+                        pose.data(), intrinsics.data(), worldPosition.data(), actualFlipped);
+                assertVectorsNearEqual(actualPixel, expectedPixel.x(), expectedPixel.y(), 1e-6);
+                EXPECT_EQ(actualFlipped, expectedFlipped);
+            }
+        }
+
         /**
          * Tests the mock blender camera matrix.
          */
@@ -9,6 +9,10 @@
 #include "StaticCalibration/residuals/CorrespondenceResidual.hpp"
 #include <utility>
 #include <StaticCalibration/residuals/CorrespondenceWithIntrinsicsResidual.hpp>
+#include <StaticCalibration/residuals/AnalyticCorrespondenceResidual.hpp>
+#include <StaticCalibration/residuals/AnalyticCorrespondenceWithIntrinsicsResidual.hpp>
+#include <StaticCalibration/residuals/CorrespondenceGroupResidual.hpp>
+#include "ceres/gradient_checker.h"
 
 using namespace static_calibration::calibration::residuals;
 
@@ -32,19 +36,57 @@ namespace static_calibration {
                 static_calibration::calibration::residuals::CorrespondenceWithIntrinsicsResidual correspondenceResidual = {
                         point.getExpectedPixel(), point,
                 };
-                correspondenceResidual(
-                        &intrinsics[0],
-                        &intrinsics[1],
-                        &intrinsics[2],
-                        &intrinsics[3],
-                        &translation.x(), &translation.y(), &translation.z(),
-                        &rotation.x(), &rotation.y(), &rotation.z(),
-                        point.getLambda(), new double(1), residual.data());
+                Eigen::Matrix<double, 6, 1> pose = static_calibration::camera::getPose(translation.data(),
+                                                                                       rotation.data());
+                correspondenceResidual(intrinsics.data(), pose.data(), point.getLambda(), residual.data());
 
                 EXPECT_NEAR(residual.x(), expectedResidual.x(), 1e-6);
                 EXPECT_NEAR(residual.y(), expectedResidual.y(), 1e-6);
             }
 
+            /**
+             * Asserts that the analytic and the automatically differentiated cost functions result in the same
+             * residuals and jacobians, and that the analytic jacobians pass the ceres gradient checker.
+             */
+            static void assertJacobiansEqual(ceres::CostFunction *analytic, ceres::CostFunction *autoDiff,
+                                             const std::vector<const double *> &parameters) {
+                ceres::NumericDiffOptions numericDiffOptions;
+                ceres::GradientChecker gradientChecker(analytic, nullptr, numericDiffOptions);
+                ceres::GradientChecker::ProbeResults results;
+                EXPECT_TRUE(gradientChecker.Probe(parameters.data(), 1e-6, &results)) << results.error_log;
+
+                int numResiduals = analytic->num_residuals();
+                ASSERT_EQ(numResiduals, autoDiff->num_residuals());
+                std::vector<double> analyticResiduals(numResiduals), autoDiffResiduals(numResiduals);
+                std::vector<std::vector<double>> analyticJacobians;
+                for (int blockSize: analytic->parameter_block_sizes()) {
+                    analyticJacobians.emplace_back(numResiduals * blockSize);
+                }
+                std::vector<std::vector<double>> autoDiffJacobians = analyticJacobians;
+                std::vector<double *> analyticJacobianPointers, autoDiffJacobianPointers;
+                for (int i = 0; i < parameters.size(); i++) {
+                    analyticJacobianPointers.emplace_back(analyticJacobians[i].data());
+                    autoDiffJacobianPointers.emplace_back(autoDiffJacobians[i].data());
+                }
+
+                EXPECT_EQ(analytic->Evaluate(parameters.data(), analyticResiduals.data(),
+                                             analyticJacobianPointers.data()),
+                          autoDiff->Evaluate(parameters.data(), autoDiffResiduals.data(),
+                                             autoDiffJacobianPointers.data()));
+                for (int r = 0; r < numResiduals; r++) {
+                    EXPECT_NEAR(analyticResiduals[r], autoDiffResiduals[r], 1e-6);
+                }
+                for (int i = 0; i < parameters.size(); i++) {
+                    for (int j = 0; j < analyticJacobians[i].size(); j++) {
+                        EXPECT_NEAR(analyticJacobians[i][j], autoDiffJacobians[i][j],
+                                    1e-6 * std::max(1., std::abs(autoDiffJacobians[i][j])));
+                    }
+                }
+
+                delete analytic;
+                delete autoDiff;
+            }
+
             /**
              * Asserts that calculating projecting the world position to the image space results in the expected
              * residual error.
@@ -118,6 +160,133 @@ namespace static_calibration {
             assertLineCorrespondenceResidual(lineOrigin, lineHeading, lambda, pixel, {0, 0});
         }
 
+        /**
+         * Tests the analytic jacobians of the correspondence residuals against the automatic differentiation and the
+         * ceres gradient checker.
+         */
+        TEST_F(ResidualsTests, testAnalyticJacobians) {
+            std::vector<Eigen::Vector3d> rotations{{90, 0, 0}, {85, 3, -7}, {100, 10, 20}};
+            std::vector<Eigen::Vector3d> origins{{0, 0, 0}, {4, 20, 5}, {-3, 40, 1}};
+            Eigen::Vector3d axis = Eigen::Vector3d(0.2, 0.1, 1).normalized();
+            Eigen::Vector2d pixel{1000, 700};
+            double lambda = 1.5;
+
+            for (const auto &eulerAngles: rotations) {
+                for (const auto &origin: origins) {
+                    static_calibration::calibration::ParametricPoint point{pixel, origin, axis, lambda, 0, 5};
+                    Eigen::Matrix<double, 6, 1> pose = static_calibration::camera::getPose(translation.data(),
+                                                                                           eulerAngles.data());
+
+                    assertJacobiansEqual(
+                            AnalyticCorrespondenceResidual::create(pixel, point, intrinsics),
+                            CorrespondenceResidual::create(pixel, point, intrinsics),
+                            {pose.data(), &lambda});
+
+                    assertJacobiansEqual(
+                            AnalyticCorrespondenceWithIntrinsicsResidual::create(pixel, point),
+                            CorrespondenceWithIntrinsicsResidual::create(pixel, point),
+                            {intrinsics.data(), pose.data(), &lambda});
+                }
+            }
+        }
+
+        /**
+         * Tests that the aggregated correspondence residual of a group of points results in the losses of the weighted
+         * single point residuals, and that its jacobians match the automatic differentiation and the gradient checker.
+         */
+        TEST_F(ResidualsTests, testCorrespondenceGroupResidual) {
+            Eigen::Matrix<double, 6, 1> pose = static_calibration::camera::getPose(translation.data(),
+                                                                                   Eigen::Vector3d(85, 3, -7).data());
+            Eigen::Vector3d origin{4, 20, 5};
+            Eigen::Vector3d axis = Eigen::Vector3d(0.2, 0.1, 1).normalized();
+            std::vector<double> lambdas{0, 0.5, 1.5, 3, 4.5};
+            std::vector<double> weights{1, 0.8, 1, 1.2, 0.9};
+            std::vector<double> offsets{0.2, -0.4, 3, -25, 0};
+
+            std::vector<static_calibration::calibration::ParametricPoint> points;
+            for (int i = 0; i < lambdas.size(); i++) {
+                Eigen::Vector3d position = origin + axis * (lambdas[i] + 0.1);
+                bool flipped;
+                Eigen::Vector2d pixel = static_calibration::camera::renderPose(pose.data(), intrinsics.data(),
+                                                                               position.data(), flipped) +
+                                        Eigen::Vector2d(offsets[i], -offsets[i]);
+                points.emplace_back(pixel, origin, axis, 5, lambdas.data() + i);
+            }
+
+            ceres::HuberLoss huberLoss(1.0);
+            double expectedCost = 0;
+            for (int i = 0; i < points.size(); i++) {
+                std::unique_ptr<ceres::CostFunction> pointResidual(
+                        CorrespondenceResidual::create(points[i].getExpectedPixel(), points[i], intrinsics));
+                const double *parameters[] = {pose.data(), &lambdas[i]};
+                Eigen::Vector2d residual;
+                ASSERT_TRUE(pointResidual->Evaluate(parameters, residual.data(), nullptr));
+                residual *= weights[i];
+                double rho[3];
+                huberLoss.Evaluate(residual.squaredNorm(), rho);
+                expectedCost += 0.5 * rho[0];
+            }
+
+            std::unique_ptr<ceres::CostFunction> groupResidual(
+                    CorrespondenceGroupResidual::create(points, intrinsics, weights.data(), new ceres::HuberLoss(1.0),
+                                                        true));
+            ASSERT_EQ(groupResidual->num_residuals(), 2 * points.size());
+            const double *parameters[] = {pose.data(), lambdas.data()};
+            Eigen::VectorXd residuals(groupResidual->num_residuals());
+            ASSERT_TRUE(groupResidual->Evaluate(parameters, residuals.data(), nullptr));
+            EXPECT_NEAR(0.5 * residuals.squaredNorm(), expectedCost, 1e-6);
+
+            assertJacobiansEqual(
+                    CorrespondenceGroupResidual::create(points, intrinsics, weights.data(), new ceres::HuberLoss(1.0),
+                                                        true),
+                    CorrespondenceGroupResidual::create(points, intrinsics, weights.data(), new ceres::HuberLoss(1.0),
+                                                        false),
+                    {pose.data(), lambdas.data()});
+
+            assertJacobiansEqual(
+                    CorrespondenceGroupResidual::createWithIntrinsics(points, weights.data(),
+                                                                      new ceres::HuberLoss(1.0), true),
+                    CorrespondenceGroupResidual::createWithIntrinsics(points, weights.data(),
+                                                                      new ceres::HuberLoss(1.0), false),
+                    {intrinsics.data(), pose.data(), lambdas.data()});
+        }
+
+        /**
+         * Tests that the correspondence residuals consume the cached camera transform only for the pose it was
+         * calculated for.
+         */
+        TEST_F(ResidualsTests, testPoseTransformCache) {
+            Eigen::Matrix<double, 6, 1> pose = static_calibration::camera::getPose(translation.data(),
+                                                                                   rotation.data());
+            PoseTransformCache cache(pose.data());
+            EXPECT_EQ(cache.getTransform(pose.data(), false), nullptr);
+
+            // A residual only evaluation does not provide the right jacobian.
+            cache.PrepareForEvaluation(false, true);
+            EXPECT_NE(cache.getTransform(pose.data(), false), nullptr);
+            EXPECT_EQ(cache.getTransform(pose.data(), true), nullptr);
+
+            cache.PrepareForEvaluation(true, false);
+            const auto *transform = cache.getTransform(pose.data(), true);
+            ASSERT_NE(transform, nullptr);
+            auto expectedTransform = static_calibration::camera::getPoseTransform(pose.data());
+            EXPECT_TRUE(transform->rotation.isApprox(expectedTransform.rotation));
+            EXPECT_TRUE(transform->rightJacobian.isApprox(expectedTransform.rightJacobian));
+
+            Eigen::Matrix<double, 6, 1> otherPose = pose;
+            otherPose[4] += 1e-3;
+            EXPECT_EQ(cache.getTransform(otherPose.data(), true), nullptr);
+
+            std::vector<double> lambdas{0.5, 2};
+            std::vector<static_calibration::calibration::ParametricPoint> points;
+            for (int i = 0; i < lambdas.size(); i++) {
+                points.emplace_back(Eigen::Vector2d(900, 500 + i * 50), Eigen::Vector3d(4, 20, 5),
+                                    Eigen::Vector3d(0, 0, 1), 5, lambdas.data() + i);
+            }
+            assertJacobiansEqual(
+                    CorrespondenceGroupResidual::create(points, intrinsics, nullptr, nullptr, true, &cache),
+                    CorrespondenceGroupResidual::create(points, intrinsics, nullptr, nullptr, false),
+                    {pose.data(), lambdas.data()});
+        }
     }
 }
-